@@ -8,6 +8,17 @@ set CompilerOptions=%CompilerOptions% /I"..\include" /DUNICODE
 set CompilerOptions=%CompilerOptions% /Zi /Fd:"glb_viewer.pdb" /Zl /c
 set InputFiles="..\source\main.c"
 set InputFiles=%InputFiles% "..\source\utils.c"
+set InputFiles=%InputFiles% "..\source\job.c"
+set InputFiles=%InputFiles% "..\source\json_scan.c"
+set InputFiles=%InputFiles% "..\source\bench.c"
+set InputFiles=%InputFiles% "..\source\float_parse.c"
+set InputFiles=%InputFiles% "..\source\vertex_convert.c"
+set InputFiles=%InputFiles% "..\source\accessor_decode.c"
+set InputFiles=%InputFiles% "..\source\mesh_cluster.c"
+set InputFiles=%InputFiles% "..\source\mesh_normals.c"
+set InputFiles=%InputFiles% "..\source\mesh_optimize.c"
+set InputFiles=%InputFiles% "..\source\mesh_simplify.c"
+set InputFiles=%InputFiles% "..\source\mesh_weld.c"
 set InputFiles=%InputFiles% "..\source\jsmn.c"
 set CompilerOptions=%CompilerOptions% %InputFiles%
 cl %CompilerOptions%
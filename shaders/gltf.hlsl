@@ -4,6 +4,17 @@ struct ROOT_CONSTANTS
     float4x4 view_proj;
 };
 [[vk::push_constant]] ROOT_CONSTANTS root_constants;
+// Set for the quantized vertex formats, the normal then holds octahedral
+// coordinates and positions are dequantized by the world matrix
+[[vk::constant_id(0)]] const bool octahedral_normals = false;
+float3 octahedral_decode(float2 e)
+{
+    float3 n = float3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = saturate(-n.z);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
 struct VS_INPUT
 {
     float3 pos : POSITION;
@@ -18,7 +29,7 @@ VS_OUTPUT vert_main(VS_INPUT input)
 {
     VS_OUTPUT output = (VS_OUTPUT)0;
     output.pos= mul(root_constants.view_proj, mul(root_constants.world, float4(input.pos, 1.0)));
-    output.nrm = input.nrm;
+    output.nrm = octahedral_normals ? octahedral_decode(input.nrm.xy) : input.nrm;
     return output;
 }
 struct PS_INPUT
@@ -0,0 +1,564 @@
+#include <intrin.h>
+
+#include "accessor_decode.h"
+
+/* The (component, normalized) pairs glTF allows, FLOAT and UNSIGNED_INT are
+ * never normalized. */
+typedef enum accessor_format {
+    accessor_format_s8,
+    accessor_format_s8_norm,
+    accessor_format_u8,
+    accessor_format_u8_norm,
+    accessor_format_s16,
+    accessor_format_s16_norm,
+    accessor_format_u16,
+    accessor_format_u16_norm,
+    accessor_format_u32,
+    accessor_format_f32,
+    accessor_format_count,
+    accessor_format_max_enum= ~(0u)
+} accessor_format;
+
+static const u32 accessor_component_size[accessor_component_f32 + 1]= {
+    [accessor_component_s8] = 1,
+    [accessor_component_u8] = 1,
+    [accessor_component_s16]= 2,
+    [accessor_component_u16]= 2,
+    [accessor_component_u32]= 4,
+    [accessor_component_f32]= 4,
+};
+
+/*============================================================================*/
+/* Scalar Kernels                                                             */
+/*============================================================================*/
+// The sign is extended by hand, __int8 follows /J and may be unsigned
+static s32
+accessor_s8(const u8 *source) {
+    return (s32)source[0] - (s32)((source[0] & 0x80u) << 1);
+}
+
+static s32
+accessor_s16(const u8 *source) {
+    u16 value= *(const u16 *)source;
+    return (s32)value - (s32)((value & 0x8000u) << 1);
+}
+
+// glTF decodes signed normalized values as max(c / (2^(n-1) - 1), -1)
+static f32
+accessor_snorm(f32 value) {
+    return value < -1.F ? -1.F : value;
+}
+
+#define ACCESSOR_SIZE_s8       1
+#define ACCESSOR_SIZE_s8_norm  1
+#define ACCESSOR_SIZE_u8       1
+#define ACCESSOR_SIZE_u8_norm  1
+#define ACCESSOR_SIZE_s16      2
+#define ACCESSOR_SIZE_s16_norm 2
+#define ACCESSOR_SIZE_u16      2
+#define ACCESSOR_SIZE_u16_norm 2
+#define ACCESSOR_SIZE_u32      4
+#define ACCESSOR_SIZE_f32      4
+
+#define ACCESSOR_LOAD_s8(p) ((f32)accessor_s8(p))
+#define ACCESSOR_LOAD_s8_norm(p)                                               \
+    accessor_snorm((f32)accessor_s8(p) * (1.F / 127.F))
+#define ACCESSOR_LOAD_u8(p)      ((f32)(p)[0])
+#define ACCESSOR_LOAD_u8_norm(p) ((f32)(p)[0] * (1.F / 255.F))
+#define ACCESSOR_LOAD_s16(p)     ((f32)accessor_s16(p))
+#define ACCESSOR_LOAD_s16_norm(p)                                              \
+    accessor_snorm((f32)accessor_s16(p) * (1.F / 32767.F))
+#define ACCESSOR_LOAD_u16(p)      ((f32)((const u16 *)(p))[0])
+#define ACCESSOR_LOAD_u16_norm(p) ((f32)((const u16 *)(p))[0] * (1.F / 65535.F))
+#define ACCESSOR_LOAD_u32(p)      ((f32)((const u32 *)(p))[0])
+#define ACCESSOR_LOAD_f32(p)      (((const f32 *)(p))[0])
+
+/* The first three components of an element, n is the component count. */
+#define ACCESSOR_VEC3_KERNEL(format, n)                                        \
+    static void accessor_vec3_##format##_##n(                                  \
+        const u8 *source,                                                      \
+        u32       stride,                                                      \
+        u32       count,                                                       \
+        void     *out) {                                                       \
+        vec3 *dest= out;                                                       \
+        for(u32 i= 0; i < count; ++i, source+= stride) {                       \
+            dest[i].x= ACCESSOR_LOAD_##format(source);                         \
+            dest[i].y= n > 1 ? ACCESSOR_LOAD_##format(                         \
+                                   source + ACCESSOR_SIZE_##format) :          \
+                               0.F;                                            \
+            dest[i].z= n > 2 ? ACCESSOR_LOAD_##format(                         \
+                                   source + 2 * ACCESSOR_SIZE_##format) :      \
+                               0.F;                                            \
+        }                                                                      \
+    }
+
+/* Every component of an element, columns of matrices with 1 and 2 byte
+ * components start 4 byte aligned and the padding is skipped. */
+#define ACCESSOR_F32_KERNEL(format, type, columns, rows)                       \
+    static void accessor_f32_##format##_##type(                                \
+        const u8 *source,                                                      \
+        u32       stride,                                                      \
+        u32       count,                                                       \
+        void     *out) {                                                       \
+        const u32 column_stride=                                               \
+            (rows * ACCESSOR_SIZE_##format + 3) & ~3u;                         \
+        f32 *dest= out;                                                        \
+        for(u32 i= 0; i < count; ++i, source+= stride) {                       \
+            for(u32 c= 0; c < columns; ++c) {                                  \
+                for(u32 r= 0; r < rows; ++r) {                                 \
+                    *dest++= ACCESSOR_LOAD_##format(                           \
+                        source + column_stride * c +                           \
+                        ACCESSOR_SIZE_##format * r);                           \
+                }                                                              \
+            }                                                                  \
+        }                                                                      \
+    }
+
+#define ACCESSOR_FORMAT_KERNELS(format)                                        \
+    ACCESSOR_VEC3_KERNEL(format, 1)                                            \
+    ACCESSOR_VEC3_KERNEL(format, 2)                                            \
+    ACCESSOR_VEC3_KERNEL(format, 3)                                            \
+    ACCESSOR_VEC3_KERNEL(format, 4)                                            \
+    ACCESSOR_F32_KERNEL(format, scalar, 1, 1)                                  \
+    ACCESSOR_F32_KERNEL(format, vec2, 1, 2)                                    \
+    ACCESSOR_F32_KERNEL(format, vec3, 1, 3)                                    \
+    ACCESSOR_F32_KERNEL(format, vec4, 1, 4)                                    \
+    ACCESSOR_F32_KERNEL(format, mat2, 2, 2)                                    \
+    ACCESSOR_F32_KERNEL(format, mat3, 3, 3)                                    \
+    ACCESSOR_F32_KERNEL(format, mat4, 4, 4)
+
+ACCESSOR_FORMAT_KERNELS(s8)
+ACCESSOR_FORMAT_KERNELS(s8_norm)
+ACCESSOR_FORMAT_KERNELS(u8)
+ACCESSOR_FORMAT_KERNELS(u8_norm)
+ACCESSOR_FORMAT_KERNELS(s16)
+ACCESSOR_FORMAT_KERNELS(s16_norm)
+ACCESSOR_FORMAT_KERNELS(u16)
+ACCESSOR_FORMAT_KERNELS(u16_norm)
+ACCESSOR_FORMAT_KERNELS(u32)
+ACCESSOR_FORMAT_KERNELS(f32)
+
+#define ACCESSOR_INDEX_KERNEL(target_type, source_type)                        \
+    static void accessor_##target_type##_##source_type(                        \
+        const u8 *source,                                                      \
+        u32       stride,                                                      \
+        u32       count,                                                       \
+        void     *out) {                                                       \
+        target_type *dest= out;                                                \
+        for(u32 i= 0; i < count; ++i, source+= stride)                         \
+            dest[i]= (target_type)((const source_type *)source)[0];            \
+    }
+
+ACCESSOR_INDEX_KERNEL(u8, u8)
+ACCESSOR_INDEX_KERNEL(u8, u16)
+ACCESSOR_INDEX_KERNEL(u8, u32)
+ACCESSOR_INDEX_KERNEL(u16, u8)
+ACCESSOR_INDEX_KERNEL(u16, u16)
+ACCESSOR_INDEX_KERNEL(u16, u32)
+ACCESSOR_INDEX_KERNEL(u32, u8)
+ACCESSOR_INDEX_KERNEL(u32, u16)
+ACCESSOR_INDEX_KERNEL(u32, u32)
+
+/*============================================================================*/
+/* SSE2 Kernels                                                               */
+/*============================================================================*/
+/* Each load widens the first four components of an element to f32 lanes.
+ * They are macros over the `zero`, `scale` and `neg_one` constants of the
+ * kernel, which keeps debug builds from spilling through helper calls.
+ * Bytes and shorts are unpacked into the top of their lane and shifted back
+ * down to extend the sign. */
+#define ACCESSOR_SSE2_BYTES(p)  _mm_cvtsi32_si128(*(const int *)(p))
+#define ACCESSOR_SSE2_SHORTS(p) _mm_loadl_epi64((const __m128i *)(p))
+#define ACCESSOR_SSE2_S8(p)                                                    \
+    _mm_srai_epi32(                                                            \
+        _mm_unpacklo_epi16(                                                    \
+            zero,                                                              \
+            _mm_unpacklo_epi8(zero, ACCESSOR_SSE2_BYTES(p))),                  \
+        24)
+#define ACCESSOR_SSE2_U8(p)                                                    \
+    _mm_unpacklo_epi16(_mm_unpacklo_epi8(ACCESSOR_SSE2_BYTES(p), zero), zero)
+#define ACCESSOR_SSE2_S16(p)                                                   \
+    _mm_srai_epi32(_mm_unpacklo_epi16(zero, ACCESSOR_SSE2_SHORTS(p)), 16)
+#define ACCESSOR_SSE2_U16(p) _mm_unpacklo_epi16(ACCESSOR_SSE2_SHORTS(p), zero)
+#define ACCESSOR_SSE2_UNORM(value) _mm_mul_ps(_mm_cvtepi32_ps(value), scale)
+#define ACCESSOR_SSE2_SNORM(value)                                             \
+    _mm_max_ps(ACCESSOR_SSE2_UNORM(value), neg_one)
+
+#define ACCESSOR_SSE2_LOAD_s8(p)       _mm_cvtepi32_ps(ACCESSOR_SSE2_S8(p))
+#define ACCESSOR_SSE2_LOAD_s8_norm(p)  ACCESSOR_SSE2_SNORM(ACCESSOR_SSE2_S8(p))
+#define ACCESSOR_SSE2_LOAD_u8(p)       _mm_cvtepi32_ps(ACCESSOR_SSE2_U8(p))
+#define ACCESSOR_SSE2_LOAD_u8_norm(p)  ACCESSOR_SSE2_UNORM(ACCESSOR_SSE2_U8(p))
+#define ACCESSOR_SSE2_LOAD_s16(p)      _mm_cvtepi32_ps(ACCESSOR_SSE2_S16(p))
+#define ACCESSOR_SSE2_LOAD_s16_norm(p) ACCESSOR_SSE2_SNORM(ACCESSOR_SSE2_S16(p))
+#define ACCESSOR_SSE2_LOAD_u16(p)      _mm_cvtepi32_ps(ACCESSOR_SSE2_U16(p))
+#define ACCESSOR_SSE2_LOAD_u16_norm(p) ACCESSOR_SSE2_UNORM(ACCESSOR_SSE2_U16(p))
+#define ACCESSOR_SSE2_LOAD_f32(p)      _mm_loadu_ps((const f32 *)(p))
+
+// Constants the loads of each format use, a kernel only declares those of
+// its own format
+#define ACCESSOR_SSE2_ZERO const __m128i zero= _mm_setzero_si128();
+#define ACCESSOR_SSE2_UNORM_CONSTANTS(factor)                                  \
+    ACCESSOR_SSE2_ZERO const __m128 scale= _mm_set1_ps(factor);
+#define ACCESSOR_SSE2_SNORM_CONSTANTS(factor)                                  \
+    ACCESSOR_SSE2_UNORM_CONSTANTS(factor)                                      \
+    const __m128 neg_one= _mm_set1_ps(-1.F);
+
+#define ACCESSOR_SSE2_CONSTANTS_s8 ACCESSOR_SSE2_ZERO
+#define ACCESSOR_SSE2_CONSTANTS_s8_norm                                        \
+    ACCESSOR_SSE2_SNORM_CONSTANTS(1.F / 127.F)
+#define ACCESSOR_SSE2_CONSTANTS_u8 ACCESSOR_SSE2_ZERO
+#define ACCESSOR_SSE2_CONSTANTS_u8_norm                                        \
+    ACCESSOR_SSE2_UNORM_CONSTANTS(1.F / 255.F)
+#define ACCESSOR_SSE2_CONSTANTS_s16 ACCESSOR_SSE2_ZERO
+#define ACCESSOR_SSE2_CONSTANTS_s16_norm                                       \
+    ACCESSOR_SSE2_SNORM_CONSTANTS(1.F / 32767.F)
+#define ACCESSOR_SSE2_CONSTANTS_u16 ACCESSOR_SSE2_ZERO
+#define ACCESSOR_SSE2_CONSTANTS_u16_norm                                       \
+    ACCESSOR_SSE2_UNORM_CONSTANTS(1.F / 65535.F)
+#define ACCESSOR_SSE2_CONSTANTS_f32
+
+/* Four elements per iteration, their xyz are packed into three registers as
+ * x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3. A VEC3 source is loaded four
+ * components wide, so its last element is left to the scalar kernel to stay
+ * inside the buffer. */
+#define ACCESSOR_VEC3_SSE2_KERNEL(format, n)                                   \
+    static u32 accessor_vec3_sse2_##format##_##n(                              \
+        const u8 *source,                                                      \
+        u32       stride,                                                      \
+        u32       count,                                                       \
+        void     *out) {                                                       \
+        ACCESSOR_SSE2_CONSTANTS_##format                                       \
+        f32 *dest= out;                                                        \
+        u32  tail= n < 4;                                                      \
+        u32  i   = 0;                                                          \
+        for(; i + 4 + tail <= count;                                           \
+            i+= 4, source+= 4 * stride, dest+= 12) {                           \
+            __m128 a = ACCESSOR_SSE2_LOAD_##format(source);                    \
+            __m128 b = ACCESSOR_SSE2_LOAD_##format(source + stride);           \
+            __m128 c = ACCESSOR_SSE2_LOAD_##format(source + 2 * stride);       \
+            __m128 d = ACCESSOR_SSE2_LOAD_##format(source + 3 * stride);       \
+            __m128 t0= _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 2, 2));          \
+            __m128 t1= _mm_shuffle_ps(c, d, _MM_SHUFFLE(0, 0, 2, 2));          \
+            _mm_storeu_ps(                                                     \
+                dest,                                                          \
+                _mm_shuffle_ps(a, t0, _MM_SHUFFLE(2, 0, 1, 0)));               \
+            _mm_storeu_ps(                                                     \
+                dest + 4,                                                      \
+                _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 0, 2, 1)));                \
+            _mm_storeu_ps(                                                     \
+                dest + 8,                                                      \
+                _mm_shuffle_ps(t1, d, _MM_SHUFFLE(2, 1, 2, 0)));               \
+        }                                                                      \
+        return i;                                                              \
+    }
+
+#define ACCESSOR_FORMAT_SSE2_KERNELS(format)                                   \
+    ACCESSOR_VEC3_SSE2_KERNEL(format, 3)                                       \
+    ACCESSOR_VEC3_SSE2_KERNEL(format, 4)
+
+ACCESSOR_FORMAT_SSE2_KERNELS(s8)
+ACCESSOR_FORMAT_SSE2_KERNELS(s8_norm)
+ACCESSOR_FORMAT_SSE2_KERNELS(u8)
+ACCESSOR_FORMAT_SSE2_KERNELS(u8_norm)
+ACCESSOR_FORMAT_SSE2_KERNELS(s16)
+ACCESSOR_FORMAT_SSE2_KERNELS(s16_norm)
+ACCESSOR_FORMAT_SSE2_KERNELS(u16)
+ACCESSOR_FORMAT_SSE2_KERNELS(u16_norm)
+ACCESSOR_FORMAT_SSE2_KERNELS(f32)
+
+/* Index sources are tightly packed, so the kernels step over whole
+ * registers and ignore the stride. */
+static u32
+accessor_sse2_u16_u8(const u8 *source, u32 stride, u32 count, void *out) {
+    const __m128i zero= _mm_setzero_si128();
+    __m128i      *dest= out;
+    u32           i   = 0;
+    for(; i + 16 <= count; i+= 16, source+= 16, dest+= 2) {
+        __m128i value= _mm_loadu_si128((const __m128i *)source);
+        _mm_storeu_si128(dest, _mm_unpacklo_epi8(value, zero));
+        _mm_storeu_si128(dest + 1, _mm_unpackhi_epi8(value, zero));
+    }
+    return i;
+}
+
+static u32
+accessor_sse2_u32_u8(const u8 *source, u32 stride, u32 count, void *out) {
+    const __m128i zero= _mm_setzero_si128();
+    __m128i      *dest= out;
+    u32           i   = 0;
+    for(; i + 16 <= count; i+= 16, source+= 16, dest+= 4) {
+        __m128i value= _mm_loadu_si128((const __m128i *)source);
+        __m128i lo   = _mm_unpacklo_epi8(value, zero);
+        __m128i hi   = _mm_unpackhi_epi8(value, zero);
+        _mm_storeu_si128(dest, _mm_unpacklo_epi16(lo, zero));
+        _mm_storeu_si128(dest + 1, _mm_unpackhi_epi16(lo, zero));
+        _mm_storeu_si128(dest + 2, _mm_unpacklo_epi16(hi, zero));
+        _mm_storeu_si128(dest + 3, _mm_unpackhi_epi16(hi, zero));
+    }
+    return i;
+}
+
+static u32
+accessor_sse2_u32_u16(const u8 *source, u32 stride, u32 count, void *out) {
+    const __m128i zero= _mm_setzero_si128();
+    __m128i      *dest= out;
+    u32           i   = 0;
+    for(; i + 8 <= count; i+= 8, source+= 16, dest+= 2) {
+        __m128i value= _mm_loadu_si128((const __m128i *)source);
+        _mm_storeu_si128(dest, _mm_unpacklo_epi16(value, zero));
+        _mm_storeu_si128(dest + 1, _mm_unpackhi_epi16(value, zero));
+    }
+    return i;
+}
+
+/* Masking to the low byte keeps the saturating packs from clamping, so they
+ * truncate like the scalar kernels. */
+static u32
+accessor_sse2_u8_u16(const u8 *source, u32 stride, u32 count, void *out) {
+    const __m128i mask= _mm_set1_epi16(0xFF);
+    __m128i      *dest= out;
+    u32           i   = 0;
+    for(; i + 16 <= count; i+= 16, source+= 32, ++dest) {
+        __m128i lo= _mm_loadu_si128((const __m128i *)source);
+        __m128i hi= _mm_loadu_si128((const __m128i *)source + 1);
+        lo        = _mm_and_si128(lo, mask);
+        hi        = _mm_and_si128(hi, mask);
+        _mm_storeu_si128(dest, _mm_packus_epi16(lo, hi));
+    }
+    return i;
+}
+
+static u32
+accessor_sse2_u8_u32(const u8 *source, u32 stride, u32 count, void *out) {
+    const __m128i mask= _mm_set1_epi32(0xFF);
+    __m128i      *dest= out;
+    u32           i   = 0;
+    for(; i + 16 <= count; i+= 16, source+= 64, ++dest) {
+        const __m128i *value= (const __m128i *)source;
+        __m128i        v0   = _mm_and_si128(_mm_loadu_si128(value), mask);
+        __m128i        v1   = _mm_and_si128(_mm_loadu_si128(value + 1), mask);
+        __m128i        v2   = _mm_and_si128(_mm_loadu_si128(value + 2), mask);
+        __m128i        v3   = _mm_and_si128(_mm_loadu_si128(value + 3), mask);
+        __m128i        lo   = _mm_packs_epi32(v0, v1);
+        __m128i        hi   = _mm_packs_epi32(v2, v3);
+        _mm_storeu_si128(dest, _mm_packus_epi16(lo, hi));
+    }
+    return i;
+}
+
+/* SSE2 only packs with signed saturation, sign extending the low 16 bits
+ * first makes the pack a plain truncation like the scalar kernel. */
+static u32
+accessor_sse2_u16_u32(const u8 *source, u32 stride, u32 count, void *out) {
+    __m128i *dest= out;
+    u32      i   = 0;
+    for(; i + 8 <= count; i+= 8, source+= 32, ++dest) {
+        __m128i lo= _mm_loadu_si128((const __m128i *)source);
+        __m128i hi= _mm_loadu_si128((const __m128i *)source + 1);
+        lo        = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+        hi        = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+        _mm_storeu_si128(dest, _mm_packs_epi32(lo, hi));
+    }
+    return i;
+}
+
+/*============================================================================*/
+/* Kernel Tables                                                              */
+/*============================================================================*/
+#define ACCESSOR_VEC3_ROW(format)                                              \
+    {                                                                          \
+        accessor_vec3_##format##_1, accessor_vec3_##format##_2,                \
+            accessor_vec3_##format##_3, accessor_vec3_##format##_4             \
+    }
+
+static const accessor_decode_func
+    accessor_vec3_kernels[accessor_format_count][4]= {
+        ACCESSOR_VEC3_ROW(s8),
+        ACCESSOR_VEC3_ROW(s8_norm),
+        ACCESSOR_VEC3_ROW(u8),
+        ACCESSOR_VEC3_ROW(u8_norm),
+        ACCESSOR_VEC3_ROW(s16),
+        ACCESSOR_VEC3_ROW(s16_norm),
+        ACCESSOR_VEC3_ROW(u16),
+        ACCESSOR_VEC3_ROW(u16_norm),
+        ACCESSOR_VEC3_ROW(u32),
+        ACCESSOR_VEC3_ROW(f32),
+};
+
+#define ACCESSOR_VEC3_SSE2_ROW(format)                                         \
+    {                                                                          \
+        null, null, accessor_vec3_sse2_##format##_3,                           \
+            accessor_vec3_sse2_##format##_4                                    \
+    }
+
+// UNSIGNED_INT doesn't convert exactly above 2^24 and stays scalar
+static const accessor_decode_simd_func
+    accessor_vec3_sse2_kernels[accessor_format_count][4]= {
+        ACCESSOR_VEC3_SSE2_ROW(s8),
+        ACCESSOR_VEC3_SSE2_ROW(s8_norm),
+        ACCESSOR_VEC3_SSE2_ROW(u8),
+        ACCESSOR_VEC3_SSE2_ROW(u8_norm),
+        ACCESSOR_VEC3_SSE2_ROW(s16),
+        ACCESSOR_VEC3_SSE2_ROW(s16_norm),
+        ACCESSOR_VEC3_SSE2_ROW(u16),
+        ACCESSOR_VEC3_SSE2_ROW(u16_norm),
+        {0},
+        ACCESSOR_VEC3_SSE2_ROW(f32),
+};
+
+#define ACCESSOR_F32_ROW(format)                                               \
+    {                                                                          \
+        accessor_f32_##format##_scalar, accessor_f32_##format##_vec2,          \
+            accessor_f32_##format##_vec3, accessor_f32_##format##_vec4,        \
+            accessor_f32_##format##_mat2, accessor_f32_##format##_mat3,        \
+            accessor_f32_##format##_mat4                                       \
+    }
+
+// SCALAR to VEC4 by row count, then MAT2 to MAT4
+static const accessor_decode_func
+    accessor_f32_kernels[accessor_format_count][7]= {
+        ACCESSOR_F32_ROW(s8),
+        ACCESSOR_F32_ROW(s8_norm),
+        ACCESSOR_F32_ROW(u8),
+        ACCESSOR_F32_ROW(u8_norm),
+        ACCESSOR_F32_ROW(s16),
+        ACCESSOR_F32_ROW(s16_norm),
+        ACCESSOR_F32_ROW(u16),
+        ACCESSOR_F32_ROW(u16_norm),
+        ACCESSOR_F32_ROW(u32),
+        ACCESSOR_F32_ROW(f32),
+};
+
+// Indices are UNSIGNED_BYTE, UNSIGNED_SHORT or UNSIGNED_INT
+static const accessor_decode_func accessor_index_kernels[3][3]= {
+    {accessor_u8_u8, accessor_u8_u16, accessor_u8_u32},
+    {accessor_u16_u8, accessor_u16_u16, accessor_u16_u32},
+    {accessor_u32_u8, accessor_u32_u16, accessor_u32_u32},
+};
+
+static const accessor_decode_simd_func accessor_index_sse2_kernels[3][3]= {
+    {null, accessor_sse2_u8_u16, accessor_sse2_u8_u32},
+    {accessor_sse2_u16_u8, null, accessor_sse2_u16_u32},
+    {accessor_sse2_u32_u8, accessor_sse2_u32_u16, null},
+};
+
+static accessor_format
+accessor_format_of(accessor_component component, bool normalized) {
+    switch(component) {
+    case accessor_component_s8:
+        return normalized ? accessor_format_s8_norm : accessor_format_s8;
+    case accessor_component_u8:
+        return normalized ? accessor_format_u8_norm : accessor_format_u8;
+    case accessor_component_s16:
+        return normalized ? accessor_format_s16_norm : accessor_format_s16;
+    case accessor_component_u16:
+        return normalized ? accessor_format_u16_norm : accessor_format_u16;
+    case accessor_component_u32:
+        return normalized ? accessor_format_max_enum : accessor_format_u32;
+    case accessor_component_f32:
+        return normalized ? accessor_format_max_enum : accessor_format_f32;
+    default: return accessor_format_max_enum;
+    }
+}
+
+bool
+accessor_decoder_make(
+    const accessor_layout *layout,
+    accessor_target        target,
+    vertex_convert_isa     isa,
+    accessor_decoder      *out) {
+    *out                  = (accessor_decoder){0};
+    accessor_format format= accessor_format_of(
+        layout->component,
+        layout->normalized);
+    u32 rows   = layout->rows;
+    u32 columns= layout->columns;
+    if(format == accessor_format_max_enum || rows < 1 || rows > 4 ||
+       columns < 1 || columns > 4 || (columns > 1 && columns != rows))
+        return false;
+    u32 component_size= accessor_component_size[layout->component];
+    u32 column_size   = component_size * rows;
+    if(columns > 1) column_size= (column_size + 3) & ~3u;
+    out->element_size= column_size * columns;
+    out->stride      = layout->byte_stride ? layout->byte_stride :
+                                             out->element_size;
+    if(out->stride < out->element_size) return false;
+    bool simd= isa != vertex_convert_isa_scalar;
+    switch(target) {
+    case accessor_target_vec3:
+        if(columns != 1) return false;
+        out->scalar     = accessor_vec3_kernels[format][rows - 1];
+        out->simd       = simd ? accessor_vec3_sse2_kernels[format][rows - 1] :
+                                 null;
+        out->target_size= sizeof(vec3);
+        out->passthrough= format == accessor_format_f32 && rows == 3 &&
+                          out->stride == sizeof(vec3);
+        break;
+    case accessor_target_f32: {
+        u32 type        = columns > 1 ? columns + 2 : rows - 1;
+        out->scalar     = accessor_f32_kernels[format][type];
+        out->target_size= sizeof(f32) * rows * columns;
+        out->passthrough= format == accessor_format_f32 &&
+                          out->stride == out->target_size;
+        break;
+    }
+    case accessor_target_u8:
+    case accessor_target_u16:
+    case accessor_target_u32: {
+        u32 source;
+        if(format == accessor_format_u8) source= 0;
+        else if(format == accessor_format_u16) source= 1;
+        else if(format == accessor_format_u32) source= 2;
+        else return false;
+        if(rows != 1 || columns != 1) return false;
+        u32 width       = target - accessor_target_u8;
+        out->scalar     = accessor_index_kernels[width][source];
+        out->target_size= 1u << width;
+        if(simd && out->stride == out->element_size)
+            out->simd= accessor_index_sse2_kernels[width][source];
+        out->passthrough= out->element_size == out->target_size &&
+                          out->stride == out->element_size;
+        break;
+    }
+    default: return false;
+    }
+    return true;
+}
+
+u64
+accessor_source_size(const accessor_decoder *decoder, u32 count) {
+    if(!count) return 0;
+    return (u64)decoder->stride * (count - 1) + decoder->element_size;
+}
+
+void
+accessor_decode(
+    const accessor_decoder *decoder,
+    const u8               *source,
+    u32                     count,
+    void                   *out) {
+    if(decoder->passthrough) {
+        __movsb(out, source, (u64)decoder->target_size * count);
+        return;
+    }
+    u32 done= 0;
+    if(decoder->simd) done= decoder->simd(source, decoder->stride, count, out);
+    decoder->scalar(
+        source + (u64)decoder->stride * done,
+        decoder->stride,
+        count - done,
+        (u8 *)out + (u64)decoder->target_size * done);
+}
+
+f32
+accessor_normalize_bound(const accessor_layout *layout, f32 value) {
+    if(!layout->normalized) return value;
+    switch(layout->component) {
+    case accessor_component_s8: return accessor_snorm(value * (1.F / 127.F));
+    case accessor_component_u8: return value * (1.F / 255.F);
+    case accessor_component_s16:
+        return accessor_snorm(value * (1.F / 32767.F));
+    case accessor_component_u16: return value * (1.F / 65535.F);
+    default: return value;
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "types.h"
+#include "vertex_convert.h"
+
+/* Table-driven decoding of glTF accessor elements. Every (component type,
+ * component count, normalized) source gets its own kernel per target, so
+ * the element loop never branches on the source format. The targets the
+ * loader fills most have SSE2 kernels in front of the scalar ones. */
+typedef enum accessor_component {
+    accessor_component_s8,
+    accessor_component_u8,
+    accessor_component_s16,
+    accessor_component_u16,
+    accessor_component_u32,
+    accessor_component_f32,
+    accessor_component_max_enum= ~(0u)
+} accessor_component;
+
+typedef enum accessor_target {
+    accessor_target_vec3, // first three components, missing ones are 0
+    accessor_target_f32,  // every component, matrix columns unpadded
+    accessor_target_u8,   // SCALAR indices, truncated to 8 bits
+    accessor_target_u16,  // SCALAR indices, truncated to 16 bits
+    accessor_target_u32,  // SCALAR indices
+    accessor_target_max_enum= ~(0u)
+} accessor_target;
+
+typedef struct accessor_layout {
+    accessor_component component;
+    u32                rows;    // components per column, 1 to 4
+    u32                columns; // 1, or the rows of a square MATn
+    bool               normalized;
+    u32                byte_stride; // 0 for tightly packed elements
+} accessor_layout;
+
+typedef void (*accessor_decode_func)(
+    const u8 *source,
+    u32       stride,
+    u32       count,
+    void     *out);
+typedef u32 (*accessor_decode_simd_func)(
+    const u8 *source,
+    u32       stride,
+    u32       count,
+    void     *out);
+
+typedef struct accessor_decoder {
+    accessor_decode_simd_func simd; // returns the elements it decoded
+    accessor_decode_func      scalar;
+    u32                       stride;
+    u32                       element_size;
+    u32                       target_size;
+    // The source already is in the target layout and can be copied
+    bool passthrough;
+} accessor_decoder;
+
+/* Fails for layouts glTF doesn't allow and for combinations the target
+ * can't hold, like matrices as vec3 or normalized indices. */
+bool
+accessor_decoder_make(
+    const accessor_layout *layout,
+    accessor_target        target,
+    vertex_convert_isa     isa,
+    accessor_decoder      *out);
+/* Bytes from the first to the end of the last of `count` elements. */
+u64
+accessor_source_size(const accessor_decoder *decoder, u32 count);
+/* `source` points at the first element, `out` receives `count` elements of
+ * the target layout. */
+void
+accessor_decode(
+    const accessor_decoder *decoder,
+    const u8               *source,
+    u32                     count,
+    void                   *out);
+/* Applies the normalization of the layout to a min or max value, which glTF
+ * stores unnormalized. */
+f32
+accessor_normalize_bound(const accessor_layout *layout, f32 value);
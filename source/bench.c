@@ -0,0 +1,82 @@
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include "bench.h"
+
+static struct {
+    HANDLE stdout_handle;
+    f64    seconds_per_tick;
+} bench;
+
+void
+bench_init(void) {
+    // The viewer links as a windows subsystem app and has no console of its
+    // own, borrow the one of the shell it was started from
+    if(AttachConsole(ATTACH_PARENT_PROCESS))
+        bench.stdout_handle= GetStdHandle(STD_OUTPUT_HANDLE);
+    LARGE_INTEGER frequency= {0};
+    QueryPerformanceFrequency(&frequency);
+    bench.seconds_per_tick= 1.0 / (f64)frequency.QuadPart;
+}
+
+f64
+bench_now(void) {
+    LARGE_INTEGER counter= {0};
+    QueryPerformanceCounter(&counter);
+    return (f64)counter.QuadPart * bench.seconds_per_tick;
+}
+
+void
+bench_print(const char *str) {
+    OutputDebugStringA(str);
+    if(bench.stdout_handle && bench.stdout_handle != INVALID_HANDLE_VALUE) {
+        DWORD written= 0;
+        WriteFile(bench.stdout_handle, str, lstrlenA(str), &written, NULL);
+    }
+}
+
+void
+bench_print_u64(u64 value) {
+    char  str[24];
+    char *cursor= &str[23];
+    *cursor     = 0;
+    do {
+        *--cursor= (char)('0' + value % 10);
+        value/= 10;
+    } while(value);
+    bench_print(cursor);
+}
+
+void
+bench_print_f64(f64 value, u32 decimals) {
+    if(value < 0.0) {
+        bench_print("-");
+        value= -value;
+    }
+    u64 scale= 1;
+    for(u32 i= 0; i < decimals; ++i) scale*= 10;
+    u64 fixed= (u64)(s64)(value * (f64)scale + 0.5);
+    bench_print_u64(fixed / scale);
+    if(!decimals) return;
+    char str[24];
+    u64  fraction= fixed % scale;
+    str[0]       = '.';
+    for(u32 i= decimals; i > 0; --i) {
+        str[i]= (char)('0' + fraction % 10);
+        fraction/= 10;
+    }
+    str[decimals + 1]= 0;
+    bench_print(str);
+}
+
+void
+bench_report_throughput(const char *name, u64 bytes, f64 seconds) {
+    bench_print(name);
+    bench_print(": ");
+    bench_print_f64((f64)bytes / seconds / 1e9, 3);
+    bench_print(" GB/s (");
+    bench_print_u64(bytes);
+    bench_print(" bytes in ");
+    bench_print_f64(seconds * 1e3, 3);
+    bench_print(" ms)\n");
+}
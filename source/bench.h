@@ -0,0 +1,18 @@
+#pragma once
+
+#include "types.h"
+
+/* Headless measurements, reported on the console of the launching shell and
+ * through OutputDebugString. */
+void
+bench_init(void);
+f64
+bench_now(void);
+void
+bench_print(const char *str);
+void
+bench_print_u64(u64 value);
+void
+bench_print_f64(f64 value, u32 decimals);
+void
+bench_report_throughput(const char *name, u64 bytes, f64 seconds);
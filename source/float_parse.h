@@ -0,0 +1,16 @@
+#pragma once
+
+#include "types.h"
+
+/* Correctly rounded (round to nearest, ties to even) conversion of JSON
+ * numbers. Short inputs with small exponents are converted exactly with one
+ * floating point multiply or divide, everything else goes through the
+ * Eisel-Lemire algorithm with a 128 bit table of powers of five. The rare
+ * inputs it cannot decide, long mantissas that straddle a rounding boundary,
+ * are settled by comparing against the halfway point with big integers.
+ * Malformed input converts the prefix that parses and never reads past
+ * `length`. */
+f64
+convert_string_to_f64(const char *str, u64 length);
+f32
+convert_string_to_f32(const char *str, u64 length);
@@ -0,0 +1,169 @@
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include "job.h"
+
+#define JOB_MAX_WORKERS (JOB_MAX_THREADS - 1)
+
+/* One dispatch, it lives on the stack of the dispatching thread. Threads
+ * join and leave it under the lock, so it outlives everyone touching it. */
+typedef struct job_batch {
+    job_func          func;
+    void             *user_data;
+    LONG              count;
+    volatile LONG     next;
+    u32               participants;
+    struct job_batch *next_batch;
+} job_batch;
+
+/* Parallel-for over [0, count) on a fixed set of worker threads, the calling
+ * thread takes part in the work. Dispatches with indices left to claim are
+ * listed newest first and idle workers join the head of the list, so a
+ * dispatch issued from inside a job is picked up by the workers that ran out
+ * of outer work instead of running serially on its caller. */
+static struct {
+    HANDLE             workers[JOB_MAX_WORKERS];
+    u32                worker_count;
+    DWORD              tls_index;
+    SRWLOCK            lock;
+    CONDITION_VARIABLE work_ready;
+    CONDITION_VARIABLE batch_done;
+    job_batch         *batch_list;
+    bool               quit;
+} job_system= {.tls_index= TLS_OUT_OF_INDEXES};
+
+static void
+job_run_batch(job_batch *batch) {
+    for(;;) {
+        LONG index= InterlockedIncrement(&batch->next) - 1;
+        if(index >= batch->count) break;
+        batch->func(batch->user_data, (u32)index);
+    }
+}
+
+/* Checks out of `batch` once it has no indices left, called under the lock.
+ * The first thread to get here unlinks it so no one else joins. */
+static void
+job_leave_batch(job_batch *batch) {
+    job_batch **link= &job_system.batch_list;
+    while(*link && *link != batch) link= &(*link)->next_batch;
+    if(*link) *link= batch->next_batch;
+    if(--batch->participants == 0)
+        WakeAllConditionVariable(&job_system.batch_done);
+}
+
+static DWORD WINAPI
+job_worker_main(LPVOID param) {
+    TlsSetValue(job_system.tls_index, param);
+    AcquireSRWLockExclusive(&job_system.lock);
+    for(;;) {
+        while(!job_system.quit && !job_system.batch_list) {
+            SleepConditionVariableSRW(
+                &job_system.work_ready,
+                &job_system.lock,
+                INFINITE,
+                0);
+        }
+        if(job_system.quit) break;
+        job_batch *batch= job_system.batch_list;
+        ++batch->participants;
+        ReleaseSRWLockExclusive(&job_system.lock);
+        job_run_batch(batch);
+        AcquireSRWLockExclusive(&job_system.lock);
+        job_leave_batch(batch);
+    }
+    ReleaseSRWLockExclusive(&job_system.lock);
+    return 0;
+}
+
+void
+job_system_init(u32 worker_count) {
+    if(worker_count == ~(0u)) {
+        SYSTEM_INFO system_info= {0};
+        GetSystemInfo(&system_info);
+        worker_count= system_info.dwNumberOfProcessors - 1;
+    }
+    if(worker_count > JOB_MAX_WORKERS) worker_count= JOB_MAX_WORKERS;
+    InitializeSRWLock(&job_system.lock);
+    InitializeConditionVariable(&job_system.work_ready);
+    InitializeConditionVariable(&job_system.batch_done);
+    job_system.tls_index= TlsAlloc();
+    for(u32 i= 0; i < worker_count; ++i) {
+        // Workers are numbered from 1, the thread that owns the job system
+        // reads 0 out of its never written slot
+        HANDLE worker= CreateThread(
+            NULL,
+            0,
+            job_worker_main,
+            (LPVOID)(ULONG_PTR)(i + 1),
+            0,
+            NULL);
+        if(!worker) break;
+        job_system.workers[job_system.worker_count++]= worker;
+    }
+}
+
+void
+job_system_shutdown(void) {
+    AcquireSRWLockExclusive(&job_system.lock);
+    job_system.quit= true;
+    ReleaseSRWLockExclusive(&job_system.lock);
+    WakeAllConditionVariable(&job_system.work_ready);
+    if(job_system.worker_count) {
+        WaitForMultipleObjects(
+            job_system.worker_count,
+            job_system.workers,
+            TRUE,
+            INFINITE);
+    }
+    for(u32 i= 0; i < job_system.worker_count; ++i)
+        CloseHandle(job_system.workers[i]);
+    if(job_system.tls_index != TLS_OUT_OF_INDEXES)
+        TlsFree(job_system.tls_index);
+    job_system.tls_index   = TLS_OUT_OF_INDEXES;
+    job_system.worker_count= 0;
+}
+
+u32
+job_system_thread_count(void) {
+    return job_system.worker_count + 1;
+}
+
+u32
+job_thread_index(void) {
+    if(job_system.tls_index == TLS_OUT_OF_INDEXES) return 0;
+    return (u32)(ULONG_PTR)TlsGetValue(job_system.tls_index);
+}
+
+void
+job_dispatch(job_func func, void *user_data, u32 count) {
+    if(count <= 1 || !job_system.worker_count) {
+        for(u32 i= 0; i < count; ++i) func(user_data, i);
+        return;
+    }
+    job_batch batch= {
+        .func        = func,
+        .user_data   = user_data,
+        .count       = (LONG)count,
+        .participants= 1};
+    u32 woken= count - 1;
+    if(woken > job_system.worker_count) woken= job_system.worker_count;
+    AcquireSRWLockExclusive(&job_system.lock);
+    batch.next_batch     = job_system.batch_list;
+    job_system.batch_list= &batch;
+    ReleaseSRWLockExclusive(&job_system.lock);
+    // Workers busy with another batch move on to the head of the list when
+    // they finish, only the sleeping ones have to be woken
+    for(u32 i= 0; i < woken; ++i) WakeConditionVariable(&job_system.work_ready);
+    job_run_batch(&batch);
+    AcquireSRWLockExclusive(&job_system.lock);
+    job_leave_batch(&batch);
+    while(batch.participants) {
+        SleepConditionVariableSRW(
+            &job_system.batch_done,
+            &job_system.lock,
+            INFINITE,
+            0);
+    }
+    ReleaseSRWLockExclusive(&job_system.lock);
+}
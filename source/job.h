@@ -0,0 +1,23 @@
+#pragma once
+
+#include "types.h"
+
+/* Upper bound on job_system_thread_count(), sizes per-thread scratch data */
+#define JOB_MAX_THREADS 64
+
+typedef void (*job_func)(void *user_data, u32 index);
+
+void
+job_system_init(u32 worker_count);
+void
+job_system_shutdown(void);
+u32
+job_system_thread_count(void);
+/* 0 on threads outside the pool, 1..worker_count on the workers. */
+u32
+job_thread_index(void);
+/* Runs func(user_data, i) for every i in [0, count) and returns once all of
+ * them are done. Jobs may dispatch again, idle workers help with the nested
+ * dispatch while its caller works on it too. */
+void
+job_dispatch(job_func func, void *user_data, u32 count);
@@ -0,0 +1,269 @@
+#include <intrin.h>
+
+#include "json_scan.h"
+#include "utils.h"
+
+typedef struct json_scan_block {
+    u64 quote;
+    u64 backslash;
+    u64 op;
+    u64 whitespace;
+} json_scan_block;
+
+static void
+json_scan_classify_sse2(const u8 *data, json_scan_block *out) {
+    const __m128i quote    = _mm_set1_epi8('"');
+    const __m128i backslash= _mm_set1_epi8('\\');
+    const __m128i lower    = _mm_set1_epi8(0x20);
+    // '[' and ']' fold onto '{' and '}' once the 0x20 bit is set
+    const __m128i open_brace = _mm_set1_epi8('{');
+    const __m128i close_brace= _mm_set1_epi8('}');
+    const __m128i colon      = _mm_set1_epi8(':');
+    const __m128i comma      = _mm_set1_epi8(',');
+    const __m128i space      = _mm_set1_epi8(' ');
+    const __m128i tab        = _mm_set1_epi8('\t');
+    const __m128i line_feed  = _mm_set1_epi8('\n');
+    const __m128i car_return = _mm_set1_epi8('\r');
+    *out= (json_scan_block){0};
+    for(u32 i= 0; i < 4; ++i) {
+        __m128i c     = _mm_loadu_si128((const __m128i *)&data[16 * i]);
+        __m128i folded= _mm_or_si128(c, lower);
+        __m128i op    = _mm_or_si128(
+            _mm_or_si128(
+                _mm_cmpeq_epi8(folded, open_brace),
+                _mm_cmpeq_epi8(folded, close_brace)),
+            _mm_or_si128(_mm_cmpeq_epi8(c, colon), _mm_cmpeq_epi8(c, comma)));
+        __m128i whitespace= _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(c, space), _mm_cmpeq_epi8(c, tab)),
+            _mm_or_si128(
+                _mm_cmpeq_epi8(c, line_feed),
+                _mm_cmpeq_epi8(c, car_return)));
+        u32 shift= 16 * i;
+        out->quote|= (u64)(u32)_mm_movemask_epi8(_mm_cmpeq_epi8(c, quote))
+                     << shift;
+        out->backslash|=
+            (u64)(u32)_mm_movemask_epi8(_mm_cmpeq_epi8(c, backslash)) << shift;
+        out->op|= (u64)(u32)_mm_movemask_epi8(op) << shift;
+        out->whitespace|= (u64)(u32)_mm_movemask_epi8(whitespace) << shift;
+    }
+}
+
+static void
+json_scan_classify_avx2(const u8 *data, json_scan_block *out) {
+    const __m256i quote      = _mm256_set1_epi8('"');
+    const __m256i backslash  = _mm256_set1_epi8('\\');
+    const __m256i lower      = _mm256_set1_epi8(0x20);
+    const __m256i open_brace = _mm256_set1_epi8('{');
+    const __m256i close_brace= _mm256_set1_epi8('}');
+    const __m256i colon      = _mm256_set1_epi8(':');
+    const __m256i comma      = _mm256_set1_epi8(',');
+    const __m256i space      = _mm256_set1_epi8(' ');
+    const __m256i tab        = _mm256_set1_epi8('\t');
+    const __m256i line_feed  = _mm256_set1_epi8('\n');
+    const __m256i car_return = _mm256_set1_epi8('\r');
+    *out= (json_scan_block){0};
+    for(u32 i= 0; i < 2; ++i) {
+        __m256i c     = _mm256_loadu_si256((const __m256i *)&data[32 * i]);
+        __m256i folded= _mm256_or_si256(c, lower);
+        __m256i op    = _mm256_or_si256(
+            _mm256_or_si256(
+                _mm256_cmpeq_epi8(folded, open_brace),
+                _mm256_cmpeq_epi8(folded, close_brace)),
+            _mm256_or_si256(
+                _mm256_cmpeq_epi8(c, colon),
+                _mm256_cmpeq_epi8(c, comma)));
+        __m256i whitespace= _mm256_or_si256(
+            _mm256_or_si256(
+                _mm256_cmpeq_epi8(c, space),
+                _mm256_cmpeq_epi8(c, tab)),
+            _mm256_or_si256(
+                _mm256_cmpeq_epi8(c, line_feed),
+                _mm256_cmpeq_epi8(c, car_return)));
+        u32 shift= 32 * i;
+        out->quote|=
+            (u64)(u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(c, quote))
+            << shift;
+        out->backslash|=
+            (u64)(u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(c, backslash))
+            << shift;
+        out->op|= (u64)(u32)_mm256_movemask_epi8(op) << shift;
+        out->whitespace|= (u64)(u32)_mm256_movemask_epi8(whitespace) << shift;
+    }
+}
+
+/* Marks the characters escaped by a backslash, `carry` holds whether the
+ * first character of the block is escaped by the end of the previous one.
+ * Backslashes are rare in glTF so the runs are walked one bit at a time. */
+static u64
+json_scan_escaped(u64 backslash, u64 *carry) {
+    u64 escaped= *carry;
+    backslash&= ~escaped;
+    *carry= 0;
+    while(backslash) {
+        unsigned long index;
+        _BitScanForward64(&index, backslash);
+        if(index == 63) {
+            *carry= 1;
+            break;
+        }
+        escaped|= 2ull << index;
+        backslash&= ~(3ull << index);
+    }
+    return escaped;
+}
+
+/* Bit i of the result is the xor of bits 0..i, turning quote positions into
+ * a mask of everything from an opening quote up to its closing quote. */
+static u64
+json_scan_prefix_xor(u64 bits) {
+    bits^= bits << 1;
+    bits^= bits << 2;
+    bits^= bits << 4;
+    bits^= bits << 8;
+    bits^= bits << 16;
+    bits^= bits << 32;
+    return bits;
+}
+
+json_scan_isa
+json_scan_best_isa(void) {
+    return cpu_has_avx2() ? json_scan_isa_avx2 : json_scan_isa_sse2;
+}
+
+int
+json_scan(
+    json_scan_isa isa,
+    const char   *json_data,
+    u64           json_length,
+    jsmntok_t    *tokens,
+    u32          *open_stack,
+    u32           token_capacity) {
+    const u8 *json         = (const u8 *)json_data;
+    u32       count        = 0;
+    int       super        = -1;
+    u32       depth        = 0;
+    s64       string_open  = -1;
+    u64       escape_carry = 0;
+    u64       string_carry = 0;
+    u64       scalar_carry = 0;
+    for(u64 base= 0; base < json_length; base+= 64) {
+        json_scan_block block;
+        const u8       *data= &json[base];
+        u8              tail[64];
+        if(json_length - base < 64) {
+            // The last partial block is padded with whitespace, which never
+            // produces an event
+            __stosb(tail, ' ', 64);
+            __movsb(tail, data, json_length - base);
+            data= tail;
+        }
+        if(isa == json_scan_isa_avx2)
+            json_scan_classify_avx2(data, &block);
+        else
+            json_scan_classify_sse2(data, &block);
+        u64 escaped  = json_scan_escaped(block.backslash, &escape_carry);
+        u64 quote    = block.quote & ~escaped;
+        u64 in_string= json_scan_prefix_xor(quote) ^ string_carry;
+        string_carry = (u64)((s64)in_string >> 63);
+        u64 outside  = ~(in_string | quote);
+        u64 scalar   = outside & ~(block.op | block.whitespace);
+        u64 events   = (block.op & outside) | quote |
+                     (scalar & ~((scalar << 1) | scalar_carry));
+        scalar_carry= scalar >> 63;
+        while(events) {
+            unsigned long index;
+            _BitScanForward64(&index, events);
+            events&= events - 1;
+            u64 pos= base + index;
+            u8  c  = json[pos];
+            switch(c) {
+            case '{':
+            case '[': {
+                if(count == token_capacity) return JSMN_ERROR_NOMEM;
+                if(super != -1) {
+                    // In strict mode an object or array can't become a key
+                    if(tokens[super].type == JSMN_OBJECT)
+                        return JSMN_ERROR_INVAL;
+                    tokens[super].size++;
+                }
+                jsmntok_t *token   = &tokens[count];
+                token->type        = c == '{' ? JSMN_OBJECT : JSMN_ARRAY;
+                token->start       = (int)pos;
+                token->end         = -1;
+                token->size        = 0;
+                open_stack[depth++]= count;
+                super              = (int)count++;
+            } break;
+            case '}':
+            case ']': {
+                if(!depth) return JSMN_ERROR_INVAL;
+                jsmntok_t *token= &tokens[open_stack[--depth]];
+                if(token->type != (c == '}' ? JSMN_OBJECT : JSMN_ARRAY))
+                    return JSMN_ERROR_INVAL;
+                token->end= (int)pos + 1;
+                super     = depth ? (int)open_stack[depth - 1] : -1;
+            } break;
+            case '"': {
+                if(string_open < 0) {
+                    string_open= (s64)pos;
+                    break;
+                }
+                if(count == token_capacity) return JSMN_ERROR_NOMEM;
+                jsmntok_t *token= &tokens[count++];
+                token->type     = JSMN_STRING;
+                token->start    = (int)string_open + 1;
+                token->end      = (int)pos;
+                token->size     = 0;
+                string_open     = -1;
+                if(super != -1) tokens[super].size++;
+            } break;
+            case ':': super= (int)count - 1; break;
+            case ',':
+                if(super != -1 && depth &&
+                   tokens[super].type != JSMN_ARRAY &&
+                   tokens[super].type != JSMN_OBJECT)
+                    super= (int)open_stack[depth - 1];
+                break;
+            case '-':
+            case '0':
+            case '1':
+            case '2':
+            case '3':
+            case '4':
+            case '5':
+            case '6':
+            case '7':
+            case '8':
+            case '9':
+            case 't':
+            case 'f':
+            case 'n': {
+                // Primitives must not be keys of an object
+                if(super != -1 && (tokens[super].type == JSMN_OBJECT ||
+                                   (tokens[super].type == JSMN_STRING &&
+                                    tokens[super].size != 0)))
+                    return JSMN_ERROR_INVAL;
+                u64 end= pos;
+                for(; end < json_length; ++end) {
+                    u8 e= json[end];
+                    if(e == ' ' || e == '\t' || e == '\n' || e == '\r' ||
+                       e == ',' || e == ']' || e == '}')
+                        break;
+                    if(e < 32 || e >= 127) return JSMN_ERROR_INVAL;
+                }
+                if(end == json_length) return JSMN_ERROR_PART;
+                if(count == token_capacity) return JSMN_ERROR_NOMEM;
+                jsmntok_t *token= &tokens[count++];
+                token->type     = JSMN_PRIMITIVE;
+                token->start    = (int)pos;
+                token->end      = (int)end;
+                token->size     = 0;
+                if(super != -1) tokens[super].size++;
+            } break;
+            default: return JSMN_ERROR_INVAL;
+            }
+        }
+    }
+    if(depth || string_open >= 0) return JSMN_ERROR_PART;
+    return (int)count;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "types.h"
+
+#define JSMN_HEADER
+#include "jsmn/jsmn.h"
+
+/* Vectorized structural indexer producing the same token array as a strict
+ * jsmn_parse(). Each 64 byte block is classified with SIMD compares into
+ * bitmasks of quotes, backslashes, operators and whitespace, string interiors
+ * are masked out with a prefix xor of the unescaped quotes and the remaining
+ * structural positions are walked with a bit scan to build the tokens.
+ * Escape sequences inside strings are not validated. */
+typedef enum json_scan_isa {
+    json_scan_isa_sse2,
+    json_scan_isa_avx2,
+    json_scan_isa_max_enum= ~(0u)
+} json_scan_isa;
+
+json_scan_isa
+json_scan_best_isa(void);
+/* Returns the token count or one of the negative jsmnerr codes, on
+ * JSMN_ERROR_NOMEM the scan has to be restarted with more tokens. Every open
+ * object or array is a token, so `open_stack` holds the enclosing tokens in
+ * `token_capacity` entries however deep the nesting goes. */
+int
+json_scan(
+    json_scan_isa isa,
+    const char   *json_data,
+    u64           json_length,
+    jsmntok_t    *tokens,
+    u32          *open_stack,
+    u32           token_capacity);
@@ -11,7 +11,18 @@
 
 #include "math.h"
 #include "types.h"
+#include "accessor_decode.h"
+#include "bench.h"
+#include "float_parse.h"
+#include "job.h"
+#include "json_scan.h"
+#include "mesh_cluster.h"
+#include "mesh_normals.h"
+#include "mesh_optimize.h"
+#include "mesh_simplify.h"
+#include "mesh_weld.h"
 #include "utils.h"
+#include "vertex_convert.h"
 
 #define JSMN_HEADER
 #include "jsmn/jsmn.h"
@@ -19,24 +30,106 @@
 #define assert(x)
 
 typedef struct gltf_allocator {
-    void *(*alloc)(u64 size);
-    void (*free)(void *addr);
+    void *(*alloc)(void *context, u64 size);
+    void (*free)(void *context, void *addr);
+    void *context;
 } gltf_allocator;
 
 static HANDLE process_heap;
 
 static void *
-gltf_alloc(u64 size) {
+gltf_alloc(void *context, u64 size) {
     return HeapAlloc(process_heap, HEAP_ZERO_MEMORY, size);
 }
 
 static void
-gltf_free(void *addr) {
+gltf_free(void *context, void *addr) {
     HeapFree(process_heap, 0, addr);
 }
 
 static gltf_allocator g_allocator= {.alloc= gltf_alloc, .free= gltf_free};
 
+/*============================================================================*/
+/* Arena Allocator                                                            */
+/*============================================================================*/
+/* Address space reserved per arena, pages are committed as it grows */
+#define GLTF_ARENA_RESERVE (1ull << 32)
+#define GLTF_ARENA_COMMIT  (1ull << 16)
+#define GLTF_ARENA_ALIGN   16ull
+
+/* Linear allocator over one reserved range. Frees are no-ops and a reset
+ * only rewinds the offset, committed pages are kept for the next load. */
+typedef struct gltf_arena {
+    u8  *base;
+    u64  committed;
+    u64  used;
+    // Memory past this offset was never handed out and is still zero from
+    // the OS, only the part below it needs clearing
+    u64  dirty;
+    u64  last_high_water;
+    u64  peak_high_water;
+    u32  load_count;
+    bool zero_memory;
+} gltf_arena;
+
+static void *
+gltf_arena_alloc(void *context, u64 size) {
+    gltf_arena *arena= context;
+    if(!arena->base) {
+        arena->base=
+            VirtualAlloc(NULL, GLTF_ARENA_RESERVE, MEM_RESERVE, PAGE_NOACCESS);
+        if(!arena->base) return null;
+    }
+    u64 offset= (arena->used + GLTF_ARENA_ALIGN - 1) & ~(GLTF_ARENA_ALIGN - 1);
+    if(size > GLTF_ARENA_RESERVE - offset) return null;
+    u64 end= offset + size;
+    if(end > arena->committed) {
+        u64 committed=
+            (end + GLTF_ARENA_COMMIT - 1) & ~(GLTF_ARENA_COMMIT - 1);
+        if(!VirtualAlloc(
+               arena->base + arena->committed,
+               committed - arena->committed,
+               MEM_COMMIT,
+               PAGE_READWRITE))
+            return null;
+        arena->committed= committed;
+    }
+    if(arena->zero_memory && offset < arena->dirty) {
+        u64 dirty_end= end < arena->dirty ? end : arena->dirty;
+        __stosb(arena->base + offset, 0, dirty_end - offset);
+    }
+    arena->used= end;
+    if(end > arena->dirty) arena->dirty= end;
+    return arena->base + offset;
+}
+
+static void
+gltf_arena_free(void *context, void *addr) {}
+
+static gltf_allocator
+gltf_arena_allocator(gltf_arena *arena) {
+    return (gltf_allocator){
+        .alloc  = gltf_arena_alloc,
+        .free   = gltf_arena_free,
+        .context= arena};
+}
+
+/* Ends a load, everything allocated since the last reset is released. */
+static void
+gltf_arena_reset(gltf_arena *arena) {
+    arena->last_high_water= arena->used;
+    if(arena->used > arena->peak_high_water)
+        arena->peak_high_water= arena->used;
+    if(arena->used) ++arena->load_count;
+    arena->used= 0;
+}
+
+static void
+gltf_arena_release(gltf_arena *arena) {
+    if(arena->base) VirtualFree(arena->base, 0, MEM_RELEASE);
+    *arena= (gltf_arena){.zero_memory= arena->zero_memory};
+}
+
 typedef struct glb_header {
     u32 magic;
     u32 version;
@@ -54,6 +147,56 @@ typedef struct glb_chunk_header {
     u32 type;
 } glb_chunk_header;
 
+/* Property names are looked up in perfect-hash tables, one per object type.
+ * The hash mixes the first, middle and last byte of a key with its length
+ * and every known key of a table owns a slot, so a lookup is one multiply
+ * and one length-checked compare. The tables and their collision-free seeds
+ * are generated by tools/gen_key_tables.py, a key is added there and the
+ * printed table pasted over the old one. */
+typedef struct gltf_key {
+    const char *str;
+    u32         length;
+    u32         id;
+} gltf_key;
+
+typedef struct gltf_key_table {
+    const gltf_key *slots;
+    u32             seed;
+    u32             shift;
+} gltf_key_table;
+
+static u32
+gltf_key_slot(const gltf_key_table *table, const char *str, u64 length) {
+    u32 hash= ((u32)(u8)str[0] << 24) | ((u32)(u8)str[length / 2] << 16) |
+              ((u32)(u8)str[length - 1] << 8) | (u32)(u8)length;
+    return (hash * table->seed) >> table->shift;
+}
+
+/* Returns the id of the key in `table`, 0 for keys the table doesn't know. */
+static u32
+gltf_lookup_key(const gltf_key_table *table, const char *str, u64 length) {
+    if(!length) return 0;
+    const gltf_key *key= &table->slots[gltf_key_slot(table, str, length)];
+    if(key->length != length || !compare_string_utf8(str, length, key->str))
+        return 0;
+    return key->id;
+}
+
+/* A tokenized JSON chunk. `skip_list[i]` is the index of the first token past
+ * the value tokens[i] and its whole subtree, so the parsers step over any
+ * value, known or not, in constant time and never rescan tokens. */
+typedef struct gltf_json_tokens {
+    const char *json_data;
+    jsmntok_t  *tokens;
+    u32        *skip_list;
+    u32         count;
+} gltf_json_tokens;
+
+static jsmntok_t *
+gltf_skip_value(const gltf_json_tokens *json, jsmntok_t *token) {
+    return &json->tokens[json->skip_list[token - json->tokens]];
+}
+
 typedef enum gltf_accessor_component_type {
     gltf_accessor_component_sbyte   = 5120u,
     gltf_accessor_component_ubyte   = 5121u,
@@ -82,70 +225,139 @@ typedef struct gltf_accessor {
     gltf_accessor_type           type;
     u32                          count;
     u64                          byte_offset;
+    bool                         normalized;
+    // Component-wise bounds, only the first four components are kept
+    u32 bounds_count;
+    f32 min[4];
+    f32 max[4];
 } gltf_accessor;
 
+typedef enum gltf_accessor_key {
+    gltf_accessor_key_unknown,
+    gltf_accessor_key_buffer_view,
+    gltf_accessor_key_byte_offset,
+    gltf_accessor_key_component_type,
+    gltf_accessor_key_count,
+    gltf_accessor_key_type,
+    gltf_accessor_key_max,
+    gltf_accessor_key_min,
+    gltf_accessor_key_normalized,
+    gltf_accessor_key_max_enum= ~(0u)
+} gltf_accessor_key;
+
+static const gltf_key gltf_accessor_key_slots[8]= {
+    [0]= {"bufferView", 10, gltf_accessor_key_buffer_view},
+    [1]= {"type", 4, gltf_accessor_key_type},
+    [2]= {"byteOffset", 10, gltf_accessor_key_byte_offset},
+    [3]= {"normalized", 10, gltf_accessor_key_normalized},
+    [4]= {"componentType", 13, gltf_accessor_key_component_type},
+    [5]= {"max", 3, gltf_accessor_key_max},
+    [6]= {"min", 3, gltf_accessor_key_min},
+    [7]= {"count", 5, gltf_accessor_key_count},
+};
+static const gltf_key_table gltf_accessor_keys= {
+    gltf_accessor_key_slots,
+    0x973082D7u,
+    29};
+
+static const gltf_key gltf_accessor_type_slots[8]= {
+    [0]= {"VEC4", 4, gltf_accessor_vec4},
+    [2]= {"SCALAR", 6, gltf_accessor_scalar},
+    [3]= {"MAT2", 4, gltf_accessor_mat2},
+    [4]= {"MAT3", 4, gltf_accessor_mat3},
+    [5]= {"VEC2", 4, gltf_accessor_vec2},
+    [6]= {"MAT4", 4, gltf_accessor_mat4},
+    [7]= {"VEC3", 4, gltf_accessor_vec3},
+};
+static const gltf_key_table gltf_accessor_types= {
+    gltf_accessor_type_slots,
+    0x1027C4D1u,
+    29};
+
+/* Parses up to `capacity` numbers of a flat number array, returns the token
+ * following the array. */
+static jsmntok_t *
+gltf_parse_f32_array(
+    f32                    *out,
+    u32                     capacity,
+    jsmntok_t              *array_token,
+    const gltf_json_tokens *json) {
+    jsmntok_t *token= &array_token[1];
+    for(int i= 0; i < array_token->size; ++i, ++token) {
+        if((u32)i >= capacity) continue;
+        out[i]= convert_string_to_f32(
+            &json->json_data[token->start],
+            token->end - token->start);
+    }
+    return token;
+}
+
 static jsmntok_t *
 gltf_parse_accessor(
-    gltf_accessor *out,
-    jsmntok_t     *accessor_token,
-    const char    *json_data) {
-    gltf_accessor accessor= {0};
+    gltf_accessor          *out,
+    jsmntok_t              *accessor_token,
+    const gltf_json_tokens *json) {
+    gltf_accessor accessor = {0};
+    u32           max_count= 0;
+    u32           min_count= 0;
     assert(accessor_token->type != JSMN_OBJECT);
-    jsmntok_t *key_token  = &accessor_token[1];
-    jsmntok_t *value_token= &accessor_token[2];
+    const char *json_data= json->json_data;
+    jsmntok_t  *key_token= &accessor_token[1];
     for(u32 i= 0; i < accessor_token->size; ++i) {
-        const char *key_str  = &json_data[key_token->start];
-        const char *value_str= &json_data[value_token->start];
-        u64         value_len= value_token->end - value_token->start;
-        if(compare_string_utf8(key_str, 10, "bufferView")) {
-            accessor.buffer_view = convert_string_to_u32(value_str, value_len);
-            key_token            = value_token + 1;
-            value_token          = key_token + 1;
-        } else if(compare_string_utf8(key_str, 10, "byteOffset")) {
-            accessor.byte_offset = convert_string_to_u32(value_str, value_len);
-            key_token            = value_token + 1;
-            value_token          = key_token + 1;
-        } else if(compare_string_utf8(key_str, 13, "componentType")) {
+        jsmntok_t  *value_token= key_token + 1;
+        const char *key_str    = &json_data[key_token->start];
+        u64         key_len    = key_token->end - key_token->start;
+        const char *value_str  = &json_data[value_token->start];
+        u64         value_len  = value_token->end - value_token->start;
+        switch(gltf_lookup_key(&gltf_accessor_keys, key_str, key_len)) {
+        case gltf_accessor_key_buffer_view:
+            accessor.buffer_view= convert_string_to_u32(value_str, value_len);
+            break;
+        case gltf_accessor_key_byte_offset:
+            accessor.byte_offset= convert_string_to_u64(value_str, value_len);
+            break;
+        case gltf_accessor_key_component_type:
             accessor.component_type= (gltf_accessor_component_type)
                 convert_string_to_u32(value_str, value_len);
-            key_token  = value_token + 1;
-            value_token= key_token + 1;
-        } else if(compare_string_utf8(key_str, 5, "count")) {
-            accessor.count = convert_string_to_u32(value_str, value_len);
-            key_token      = value_token + 1;
-            value_token    = key_token + 1;
-        } else if(compare_string_utf8(key_str, 4, "type")) {
-            accessor.type= (gltf_accessor_type)0;
-            if(compare_string_utf8(value_str, value_len, "SCALAR"))
-                accessor.type= gltf_accessor_scalar;
-            else if(compare_string_utf8(value_str, value_len, "VEC2"))
-                accessor.type= gltf_accessor_vec2;
-            else if(compare_string_utf8(value_str, value_len, "VEC3"))
-                accessor.type= gltf_accessor_vec3;
-            else if(compare_string_utf8(value_str, value_len, "VEC4"))
-                accessor.type= gltf_accessor_vec4;
-            else if(compare_string_utf8(value_str, value_len, "MAT2"))
-                accessor.type= gltf_accessor_mat2;
-            else if(compare_string_utf8(value_str, value_len, "MAT3"))
-                accessor.type= gltf_accessor_mat3;
-            else if(compare_string_utf8(value_str, value_len, "MAT4"))
-                accessor.type= gltf_accessor_mat4;
-            key_token  = value_token + 1;
-            value_token= key_token + 1;
-        } else if(compare_string_utf8(key_str, 3, "max")) {
-            key_token  = value_token + value_token->size + 1;
-            value_token= key_token + 1;
-        } else if(compare_string_utf8(key_str, 3, "min")) {
-            key_token  = value_token + value_token->size + 1;
-            value_token= key_token + 1;
+            break;
+        case gltf_accessor_key_count:
+            accessor.count= convert_string_to_u32(value_str, value_len);
+            break;
+        case gltf_accessor_key_type:
+            accessor.type= (gltf_accessor_type)gltf_lookup_key(
+                &gltf_accessor_types,
+                value_str,
+                value_len);
+            break;
+        case gltf_accessor_key_max:
+            max_count= value_token->size;
+            gltf_parse_f32_array(accessor.max, 4, value_token, json);
+            break;
+        case gltf_accessor_key_min:
+            min_count= value_token->size;
+            gltf_parse_f32_array(accessor.min, 4, value_token, json);
+            break;
+        case gltf_accessor_key_normalized:
+            accessor.normalized= value_len && value_str[0] == 't';
+            break;
         }
+        key_token= gltf_skip_value(json, value_token);
     }
+    // A component is only bounded with both its min and max
+    accessor.bounds_count= max_count < min_count ? max_count : min_count;
+    if(accessor.bounds_count > 4) accessor.bounds_count= 4;
     if(out) {
         out->buffer_view   = accessor.buffer_view;
         out->byte_offset   = accessor.byte_offset;
         out->component_type= accessor.component_type;
         out->type          = accessor.type;
         out->count         = accessor.count;
+        out->normalized    = accessor.normalized;
+        out->bounds_count  = accessor.bounds_count;
+        for(u32 i= 0; i < 4; ++i) {
+            out->min[i]= accessor.min[i];
+            out->max[i]= accessor.max[i];
+        }
     }
     return key_token;
 }
@@ -154,23 +366,40 @@ typedef struct gltf_buffer {
     u64 byte_length;
 } gltf_buffer;
 
+typedef enum gltf_buffer_key {
+    gltf_buffer_key_unknown,
+    gltf_buffer_key_byte_length,
+    gltf_buffer_key_max_enum= ~(0u)
+} gltf_buffer_key;
+
+static const gltf_key gltf_buffer_key_slots[2]= {
+    [1]= {"byteLength", 10, gltf_buffer_key_byte_length},
+};
+static const gltf_key_table gltf_buffer_keys= {
+    gltf_buffer_key_slots,
+    0x2265B1F5u,
+    31};
+
 static jsmntok_t *
 gltf_parse_buffer(
-    gltf_buffer *out,
-    jsmntok_t   *buffer_token,
-    const char  *json_data) {
-    gltf_buffer buffer     = {0};
-    jsmntok_t  *key_token  = &buffer_token[1];
-    jsmntok_t  *value_token= &buffer_token[2];
+    gltf_buffer            *out,
+    jsmntok_t              *buffer_token,
+    const gltf_json_tokens *json) {
+    gltf_buffer buffer   = {0};
+    const char *json_data= json->json_data;
+    jsmntok_t  *key_token= &buffer_token[1];
     for(u32 i= 0; i < buffer_token->size; ++i) {
-        const char *key_str  = &json_data[key_token->start];
-        const char *value_str= &json_data[value_token->start];
-        u64         value_len= value_token->end - value_token->start;
-        if(compare_string_utf8(key_str, 10, "byteLength")) {
-            buffer.byte_length= convert_string_to_u32(value_str, value_len);
-            key_token         = value_token + 1;
-            value_token       = key_token + 1;
+        jsmntok_t  *value_token= key_token + 1;
+        const char *key_str    = &json_data[key_token->start];
+        u64         key_len    = key_token->end - key_token->start;
+        const char *value_str  = &json_data[value_token->start];
+        u64         value_len  = value_token->end - value_token->start;
+        switch(gltf_lookup_key(&gltf_buffer_keys, key_str, key_len)) {
+        case gltf_buffer_key_byte_length:
+            buffer.byte_length= convert_string_to_u64(value_str, value_len);
+            break;
         }
+        key_token= gltf_skip_value(json, value_token);
     }
     if(out) out->byte_length= buffer.byte_length;
     return key_token;
@@ -185,166 +414,286 @@ typedef enum gltf_buffer_view_target {
 
 typedef struct gltf_buffer_view {
     u32                     buffer;
-    u32                     byte_length;
-    u32                     byte_offset;
+    u64                     byte_length;
+    u64                     byte_offset;
     u32                     byte_stride;
     gltf_buffer_view_target target;
 } gltf_buffer_view;
 
+typedef enum gltf_buffer_view_key {
+    gltf_buffer_view_key_unknown,
+    gltf_buffer_view_key_buffer,
+    gltf_buffer_view_key_byte_length,
+    gltf_buffer_view_key_byte_offset,
+    gltf_buffer_view_key_byte_stride,
+    gltf_buffer_view_key_target,
+    gltf_buffer_view_key_max_enum= ~(0u)
+} gltf_buffer_view_key;
+
+static const gltf_key gltf_buffer_view_key_slots[8]= {
+    [0]= {"byteOffset", 10, gltf_buffer_view_key_byte_offset},
+    [4]= {"target", 6, gltf_buffer_view_key_target},
+    [5]= {"byteLength", 10, gltf_buffer_view_key_byte_length},
+    [6]= {"buffer", 6, gltf_buffer_view_key_buffer},
+    [7]= {"byteStride", 10, gltf_buffer_view_key_byte_stride},
+};
+static const gltf_key_table gltf_buffer_view_keys= {
+    gltf_buffer_view_key_slots,
+    0x2265B1F5u,
+    29};
+
 static jsmntok_t *
 gltf_parse_buffer_view(
-    gltf_buffer_view *out,
-    jsmntok_t        *buffer_view_token,
-    const char       *json_data) {
+    gltf_buffer_view       *out,
+    jsmntok_t              *buffer_view_token,
+    const gltf_json_tokens *json) {
     gltf_buffer_view buffer_view= {0};
+    const char      *json_data  = json->json_data;
     jsmntok_t       *key_token  = &buffer_view_token[1];
-    jsmntok_t       *value_token= &buffer_view_token[2];
     for(u32 i= 0; i < buffer_view_token->size; ++i) {
-        const char *key_str  = &json_data[key_token->start];
-        const char *value_str= &json_data[value_token->start];
-        u64         value_len= value_token->end - value_token->start;
-        if(compare_string_utf8(key_str, 6, "buffer")) {
+        jsmntok_t  *value_token= key_token + 1;
+        const char *key_str    = &json_data[key_token->start];
+        u64         key_len    = key_token->end - key_token->start;
+        const char *value_str  = &json_data[value_token->start];
+        u64         value_len  = value_token->end - value_token->start;
+        switch(gltf_lookup_key(&gltf_buffer_view_keys, key_str, key_len)) {
+        case gltf_buffer_view_key_buffer:
             buffer_view.buffer= convert_string_to_u32(value_str, value_len);
-            key_token         = value_token + 1;
-            value_token       = key_token + 1;
-        } else if(compare_string_utf8(key_str, 10, "byteLength")) {
+            break;
+        case gltf_buffer_view_key_byte_length:
             buffer_view.byte_length=
-                convert_string_to_u32(value_str, value_len);
-            key_token  = value_token + 1;
-            value_token= key_token + 1;
-        } else if(compare_string_utf8(key_str, 10, "byteOffset")) {
+                convert_string_to_u64(value_str, value_len);
+            break;
+        case gltf_buffer_view_key_byte_offset:
             buffer_view.byte_offset=
+                convert_string_to_u64(value_str, value_len);
+            break;
+        case gltf_buffer_view_key_byte_stride:
+            buffer_view.byte_stride=
                 convert_string_to_u32(value_str, value_len);
-            key_token  = value_token + 1;
-            value_token= key_token + 1;
-        } else if(compare_string_utf8(key_str, 6, "target")) {
-            key_token  = value_token + 1;
-            value_token= key_token + 1;
+            break;
+        case gltf_buffer_view_key_target:
+            switch(convert_string_to_u32(value_str, value_len)) {
+            case 34962u: // ARRAY_BUFFER
+                buffer_view.target= gltf_buffer_view_target_array_buffer;
+                break;
+            case 34963u: // ELEMENT_ARRAY_BUFFER
+                buffer_view.target=
+                    gltf_buffer_view_target_element_array_buffer;
+                break;
+            }
+            break;
         }
+        key_token= gltf_skip_value(json, value_token);
     }
     if(out) {
         out->buffer     = buffer_view.buffer;
         out->byte_length= buffer_view.byte_length;
         out->byte_offset= buffer_view.byte_offset;
+        out->byte_stride= buffer_view.byte_stride;
+        out->target     = buffer_view.target;
     }
     return key_token;
 }
 
 static jsmntok_t *
-gltf_parse_image(void *out, jsmntok_t *image_token, const char *json_data) {
-    return image_token + 5;
+gltf_parse_image(
+    void                   *out,
+    jsmntok_t              *image_token,
+    const gltf_json_tokens *json) {
+    return gltf_skip_value(json, image_token);
 }
 
+typedef enum gltf_pbr_key {
+    gltf_pbr_key_unknown,
+    gltf_pbr_key_base_color_factor,
+    gltf_pbr_key_base_color_texture,
+    gltf_pbr_key_metallic_factor,
+    gltf_pbr_key_metallic_texture,
+    gltf_pbr_key_max_enum= ~(0u)
+} gltf_pbr_key;
+
+static const gltf_key gltf_pbr_key_slots[4]= {
+    [0]= {"baseColorFactor", 15, gltf_pbr_key_base_color_factor},
+    [1]= {"baseColorTexture", 16, gltf_pbr_key_base_color_texture},
+    [2]= {"metallicFactor", 14, gltf_pbr_key_metallic_factor},
+    [3]= {"metallicTexture", 15, gltf_pbr_key_metallic_texture},
+};
+static const gltf_key_table gltf_pbr_keys= {
+    gltf_pbr_key_slots,
+    0x91B7584Bu,
+    30};
+
 static jsmntok_t *
-gltf_parse_pbr(void *out, jsmntok_t *pbr_token, const char *json_data) {
-    jsmntok_t *key_token  = &pbr_token[1];
-    jsmntok_t *value_token= &pbr_token[2];
+gltf_parse_pbr(
+    void                   *out,
+    jsmntok_t              *pbr_token,
+    const gltf_json_tokens *json) {
+    jsmntok_t *key_token= &pbr_token[1];
     for(u32 i= 0; i < pbr_token->size; ++i) {
-        const char *key_str  = &json_data[key_token->start];
-        const char *value_str= &json_data[value_token->start];
-        u64         value_len= value_token->end - value_token->start;
-        if(compare_string_utf8(key_str, 15, "baseColorFactor")) {
-            key_token  = value_token + 5;
-            value_token= key_token + 1;
-        } else if(compare_string_utf8(key_str, 16, "baseColorTexture")) {
-            key_token  = value_token + 3;
-            value_token= key_token + 1;
-        } else if(compare_string_utf8(key_str, 14, "metallicFactor")) {
-            key_token  = value_token + 1;
-            value_token= key_token + 1;
-        } else if(compare_string_utf8(key_str, 15, "metallicTexture")) {
-            key_token  = value_token + 3;
-            value_token= key_token + 1;
+        jsmntok_t  *value_token= key_token + 1;
+        const char *key_str    = &json->json_data[key_token->start];
+        u64         key_len    = key_token->end - key_token->start;
+        switch(gltf_lookup_key(&gltf_pbr_keys, key_str, key_len)) {
+        case gltf_pbr_key_base_color_factor:
+        case gltf_pbr_key_base_color_texture:
+        case gltf_pbr_key_metallic_factor:
+        case gltf_pbr_key_metallic_texture: break;
         }
+        key_token= gltf_skip_value(json, value_token);
     }
     return key_token;
 }
 
+typedef enum gltf_material_key {
+    gltf_material_key_unknown,
+    gltf_material_key_emissive_factor,
+    gltf_material_key_emissive_texture,
+    gltf_material_key_normal_texture,
+    gltf_material_key_occlusion_texture,
+    gltf_material_key_name,
+    gltf_material_key_pbr_metallic_roughness,
+    gltf_material_key_max_enum= ~(0u)
+} gltf_material_key;
+
+static const gltf_key gltf_material_key_slots[8]= {
+    [0]= {"emissiveTexture", 15, gltf_material_key_emissive_texture},
+    [1]= {"normalTexture", 13, gltf_material_key_normal_texture},
+    [2]= {"pbrMetallicRoughness", 20, gltf_material_key_pbr_metallic_roughness},
+    [3]= {"occlusionTexture", 16, gltf_material_key_occlusion_texture},
+    [4]= {"emissiveFactor", 14, gltf_material_key_emissive_factor},
+    [7]= {"name", 4, gltf_material_key_name},
+};
+static const gltf_key_table gltf_material_keys= {
+    gltf_material_key_slots,
+    0xD8F16ADFu,
+    29};
+
 static jsmntok_t *
 gltf_parse_material(
-    void       *out,
-    jsmntok_t  *material_token,
-    const char *json_data) {
-    jsmntok_t *key_token  = &material_token[1];
-    jsmntok_t *value_token= &material_token[2];
+    void                   *out,
+    jsmntok_t              *material_token,
+    const gltf_json_tokens *json) {
+    jsmntok_t *key_token= &material_token[1];
     for(u32 i= 0; i < material_token->size; ++i) {
-        const char *key_str  = &json_data[key_token->start];
-        const char *value_str= &json_data[value_token->start];
-        u64         value_len= value_token->end - value_token->start;
-        if(compare_string_utf8(key_str, 14, "emissiveFactor")) {
-            key_token  = value_token + 3;
-            value_token= key_token + 1;
-        } else if(compare_string_utf8(key_str, 15, "emissiveTexture")) {
-            key_token  = value_token + 3;
-            value_token= key_token + 1;
-        } else if(compare_string_utf8(key_str, 13, "normalTexture")) {
-            key_token  = value_token + 3;
-            value_token= key_token + 1;
-        } else if(compare_string_utf8(key_str, 17, "occlusionTexture")) {
-            key_token  = value_token + 3;
-            value_token= key_token + 1;
-        } else if(compare_string_utf8(key_str, 4, "name")) {
-            key_token  = value_token + 1;
-            value_token= key_token + 1;
-        } else if(compare_string_utf8(key_str, 20, "pbrMetallicRoughness")) {
-            key_token= gltf_parse_pbr(null, value_token, json_data);
+        jsmntok_t  *value_token= key_token + 1;
+        const char *key_str    = &json->json_data[key_token->start];
+        u64         key_len    = key_token->end - key_token->start;
+        switch(gltf_lookup_key(&gltf_material_keys, key_str, key_len)) {
+        case gltf_material_key_emissive_factor:
+        case gltf_material_key_emissive_texture:
+        case gltf_material_key_normal_texture:
+        case gltf_material_key_occlusion_texture:
+        case gltf_material_key_name: break;
+        case gltf_material_key_pbr_metallic_roughness:
+            gltf_parse_pbr(null, value_token, json);
+            break;
         }
+        key_token= gltf_skip_value(json, value_token);
     }
     return key_token;
 }
 
+// Accessor index of attributes a primitive doesn't have
+#define GLTF_NO_ACCESSOR (~0u)
+
 typedef struct gltf_mesh_primitive {
     u32 pos_accessor;
-    u32 nrm_accessor;
-    u32 idx_accessor;
+    u32 nrm_accessor; // GLTF_NO_ACCESSOR without NORMAL
+    u32 idx_accessor; // GLTF_NO_ACCESSOR for non-indexed primitives
     u32 material;
     u32 mode; // TODO: Enum
 } gltf_mesh_primitive;
 
+typedef enum gltf_primitive_key {
+    gltf_primitive_key_unknown,
+    gltf_primitive_key_attributes,
+    gltf_primitive_key_indices,
+    gltf_primitive_key_material,
+    gltf_primitive_key_mode,
+    gltf_primitive_key_max_enum= ~(0u)
+} gltf_primitive_key;
+
+static const gltf_key gltf_primitive_key_slots[4]= {
+    [0]= {"indices", 7, gltf_primitive_key_indices},
+    [1]= {"mode", 4, gltf_primitive_key_mode},
+    [2]= {"material", 8, gltf_primitive_key_material},
+    [3]= {"attributes", 10, gltf_primitive_key_attributes},
+};
+static const gltf_key_table gltf_primitive_keys= {
+    gltf_primitive_key_slots,
+    0x2265B1F5u,
+    30};
+
+typedef enum gltf_attribute_key {
+    gltf_attribute_key_unknown,
+    gltf_attribute_key_position,
+    gltf_attribute_key_normal,
+    gltf_attribute_key_max_enum= ~(0u)
+} gltf_attribute_key;
+
+static const gltf_key gltf_attribute_key_slots[2]= {
+    [0]= {"NORMAL", 6, gltf_attribute_key_normal},
+    [1]= {"POSITION", 8, gltf_attribute_key_position},
+};
+static const gltf_key_table gltf_attribute_keys= {
+    gltf_attribute_key_slots,
+    0x91B7584Bu,
+    31};
+
 static jsmntok_t *
 gltf_parse_mesh_primitive(
-    gltf_mesh_primitive *out,
-    jsmntok_t           *prim_token,
-    const char          *json_data) {
-    gltf_mesh_primitive prim       = {0};
-    prim.mode                      = 4; // TODO: Enum
-    jsmntok_t *key_token  = &prim_token[1];
-    jsmntok_t *value_token= &prim_token[2];
+    gltf_mesh_primitive    *out,
+    jsmntok_t              *prim_token,
+    const gltf_json_tokens *json) {
+    gltf_mesh_primitive prim= {0};
+    prim.nrm_accessor       = GLTF_NO_ACCESSOR;
+    prim.idx_accessor       = GLTF_NO_ACCESSOR;
+    prim.mode               = 4; // TODO: Enum
+    const char *json_data   = json->json_data;
+    jsmntok_t  *key_token   = &prim_token[1];
     for(u32 i= 0; i < prim_token->size; ++i) {
-        const char *key_str  = &json_data[key_token->start];
-        const char *value_str= &json_data[value_token->start];
-        u64         value_len= value_token->end - value_token->start;
-        if(compare_string_utf8(key_str, 10, "attributes")) {
-            jsmntok_t *attributes_token= value_token;
-            key_token                  = &attributes_token[1];
-            value_token                = &attributes_token[2];
-            for(u32 i= 0; i < attributes_token->size; ++i) {
-                key_str  = &json_data[key_token->start];
-                value_str= &json_data[value_token->start];
-                value_len= value_token->end - value_token->start;
-                if(compare_string_utf8(key_str, 8, "POSITION")) {
+        jsmntok_t  *value_token= key_token + 1;
+        const char *key_str    = &json_data[key_token->start];
+        u64         key_len    = key_token->end - key_token->start;
+        const char *value_str  = &json_data[value_token->start];
+        u64         value_len  = value_token->end - value_token->start;
+        switch(gltf_lookup_key(&gltf_primitive_keys, key_str, key_len)) {
+        case gltf_primitive_key_attributes: {
+            jsmntok_t *attribute_token= &value_token[1];
+            for(u32 i= 0; i < value_token->size; ++i) {
+                jsmntok_t *accessor_token= attribute_token + 1;
+                key_str  = &json_data[attribute_token->start];
+                key_len  = attribute_token->end - attribute_token->start;
+                value_str= &json_data[accessor_token->start];
+                value_len= accessor_token->end - accessor_token->start;
+                switch(gltf_lookup_key(
+                    &gltf_attribute_keys,
+                    key_str,
+                    key_len)) {
+                case gltf_attribute_key_position:
                     prim.pos_accessor=
                         convert_string_to_u32(value_str, value_len);
-                } else if(compare_string_utf8(key_str, 6, "NORMAL")) {
+                    break;
+                case gltf_attribute_key_normal:
                     prim.nrm_accessor=
                         convert_string_to_u32(value_str, value_len);
+                    break;
                 }
-                key_token  = value_token + 1;
-                value_token= key_token + 1;
+                attribute_token= gltf_skip_value(json, accessor_token);
             }
-        } else if(compare_string_utf8(key_str, 7, "indices")) {
+        } break;
+        case gltf_primitive_key_indices:
             prim.idx_accessor= convert_string_to_u32(value_str, value_len);
-            key_token        = value_token + 1;
-            value_token      = key_token + 1;
-        } else if(compare_string_utf8(key_str, 8, "material")) {
+            break;
+        case gltf_primitive_key_material:
             prim.material= convert_string_to_u32(value_str, value_len);
-            key_token    = value_token + 1;
-            value_token  = key_token + 1;
-        } else if(compare_string_utf8(key_str, 4, "mode")) {
-            prim.mode  = convert_string_to_u32(value_str, value_len);
-            key_token  = value_token + 1;
-            value_token= key_token + 1;
+            break;
+        case gltf_primitive_key_mode:
+            prim.mode= convert_string_to_u32(value_str, value_len);
+            break;
         }
+        key_token= gltf_skip_value(json, value_token);
     }
     if(out) {
         out->pos_accessor= prim.pos_accessor;
@@ -356,209 +705,3895 @@ gltf_parse_mesh_primitive(
     return key_token;
 }
 
+/* The primitives of every mesh share one array in gltf_json_data, a mesh is
+ * its range in there. */
 typedef struct gltf_mesh {
-    u64                  primitive_count;
-    gltf_mesh_primitive *primitive_list;
+    u32 first_primitive;
+    u32 primitive_count;
 } gltf_mesh;
 
+typedef enum gltf_mesh_key {
+    gltf_mesh_key_unknown,
+    gltf_mesh_key_name,
+    gltf_mesh_key_primitives,
+    gltf_mesh_key_max_enum= ~(0u)
+} gltf_mesh_key;
+
+static const gltf_key gltf_mesh_key_slots[2]= {
+    [0]= {"name", 4, gltf_mesh_key_name},
+    [1]= {"primitives", 10, gltf_mesh_key_primitives},
+};
+static const gltf_key_table gltf_mesh_keys= {
+    gltf_mesh_key_slots,
+    0x91B7584Bu,
+    31};
+
+/* Sets the primitive count of `out`, and with a `primitive_list` parses the
+ * primitives into their range starting at out->first_primitive. */
 static jsmntok_t *
 gltf_parse_mesh(
-    gltf_mesh            *out,
-    jsmntok_t            *mesh_token,
-    const char           *json_data,
-    const gltf_allocator *allocator) {
-    gltf_mesh  mesh       = {0};
-    jsmntok_t *key_token  = &mesh_token[1];
-    jsmntok_t *value_token= &mesh_token[2];
+    gltf_mesh              *out,
+    jsmntok_t              *mesh_token,
+    const gltf_json_tokens *json,
+    gltf_mesh_primitive    *primitive_list) {
+    jsmntok_t *key_token= &mesh_token[1];
+    u32        count    = 0;
     for(u32 i= 0; i < mesh_token->size; ++i) {
-        const char *key_str  = &json_data[key_token->start];
-        const char *value_str= &json_data[value_token->start];
-        u64         value_len= value_token->end - value_token->start;
-        if(compare_string_utf8(key_str, 4, "name")) {
-            key_token  = value_token + 1;
-        } else if(compare_string_utf8(key_str, 10, "primitives")) {
-            jsmntok_t *out_token= &key_token[2];
-            mesh.primitive_count= value_token->size;
-            if(out) {
-                mesh.primitive_list= allocator->alloc(
-                    sizeof(gltf_mesh_primitive) * mesh.primitive_count);
+        jsmntok_t  *value_token= key_token + 1;
+        const char *key_str    = &json->json_data[key_token->start];
+        u64         key_len    = key_token->end - key_token->start;
+        switch(gltf_lookup_key(&gltf_mesh_keys, key_str, key_len)) {
+        case gltf_mesh_key_name: break;
+        case gltf_mesh_key_primitives: {
+            count= value_token->size;
+            if(!primitive_list || !out) break;
+            jsmntok_t *out_token= &value_token[1];
+            for(u32 i= 0; i < value_token->size; ++i) {
+                gltf_mesh_primitive *primitive=
+                    &primitive_list[out->first_primitive + i];
+                out_token=
+                    gltf_parse_mesh_primitive(primitive, out_token, json);
+            }
+        } break;
+        }
+        key_token= gltf_skip_value(json, value_token);
+    }
+    if(out) out->primitive_count= count;
+    return key_token;
+}
+
+typedef enum gltf_scene_key {
+    gltf_scene_key_unknown,
+    gltf_scene_key_name,
+    gltf_scene_key_nodes,
+    gltf_scene_key_max_enum= ~(0u)
+} gltf_scene_key;
+
+static const gltf_key gltf_scene_key_slots[2]= {
+    [0]= {"nodes", 5, gltf_scene_key_nodes},
+    [1]= {"name", 4, gltf_scene_key_name},
+};
+static const gltf_key_table gltf_scene_keys= {
+    gltf_scene_key_slots,
+    0x2265B1F5u,
+    31};
+
+static jsmntok_t *
+gltf_parse_scene(
+    void                   *out,
+    jsmntok_t              *scene_token,
+    const gltf_json_tokens *json) {
+    jsmntok_t *key_token= &scene_token[1];
+    for(u32 i= 0; i < scene_token->size; ++i) {
+        jsmntok_t  *value_token= key_token + 1;
+        const char *key_str    = &json->json_data[key_token->start];
+        u64         key_len    = key_token->end - key_token->start;
+        switch(gltf_lookup_key(&gltf_scene_keys, key_str, key_len)) {
+        case gltf_scene_key_name:
+        case gltf_scene_key_nodes: break;
+        }
+        key_token= gltf_skip_value(json, value_token);
+    }
+    return key_token;
+}
+
+/* Local transform, either `matrix` or the TRS properties apply. */
+typedef struct gltf_node {
+    u32    mesh;
+    bool   has_mesh;
+    bool   has_matrix;
+    mat4x4 matrix;
+    vec4   rotation;
+    vec3   translation;
+    vec3   scale;
+} gltf_node;
+
+typedef enum gltf_node_key {
+    gltf_node_key_unknown,
+    gltf_node_key_name,
+    gltf_node_key_mesh,
+    gltf_node_key_children,
+    gltf_node_key_matrix,
+    gltf_node_key_rotation,
+    gltf_node_key_translation,
+    gltf_node_key_scale,
+    gltf_node_key_max_enum= ~(0u)
+} gltf_node_key;
+
+static const gltf_key gltf_node_key_slots[8]= {
+    [0]= {"rotation", 8, gltf_node_key_rotation},
+    [2]= {"children", 8, gltf_node_key_children},
+    [3]= {"mesh", 4, gltf_node_key_mesh},
+    [4]= {"scale", 5, gltf_node_key_scale},
+    [5]= {"matrix", 6, gltf_node_key_matrix},
+    [6]= {"translation", 11, gltf_node_key_translation},
+    [7]= {"name", 4, gltf_node_key_name},
+};
+static const gltf_key_table gltf_node_keys= {
+    gltf_node_key_slots,
+    0x64AC5DB9u,
+    29};
+
+static jsmntok_t *
+gltf_parse_node(
+    gltf_node              *out,
+    jsmntok_t              *node_token,
+    const gltf_json_tokens *json) {
+    gltf_node node= {
+        .matrix.data= {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1},
+        .rotation   = {0, 0, 0, 1},
+        .scale      = {1, 1, 1}};
+    const char *json_data= json->json_data;
+    jsmntok_t  *key_token= &node_token[1];
+    for(u32 i= 0; i < node_token->size; ++i) {
+        jsmntok_t  *value_token= key_token + 1;
+        const char *key_str    = &json_data[key_token->start];
+        u64         key_len    = key_token->end - key_token->start;
+        const char *value_str  = &json_data[value_token->start];
+        u64         value_len  = value_token->end - value_token->start;
+        switch(gltf_lookup_key(&gltf_node_keys, key_str, key_len)) {
+        case gltf_node_key_name:
+        case gltf_node_key_children: break;
+        case gltf_node_key_mesh:
+            node.mesh    = convert_string_to_u32(value_str, value_len);
+            node.has_mesh= true;
+            break;
+        case gltf_node_key_matrix:
+            node.has_matrix= true;
+            gltf_parse_f32_array(node.matrix.data, 16, value_token, json);
+            break;
+        case gltf_node_key_rotation:
+            gltf_parse_f32_array(node.rotation.data, 4, value_token, json);
+            break;
+        case gltf_node_key_translation:
+            gltf_parse_f32_array(node.translation.data, 3, value_token, json);
+            break;
+        case gltf_node_key_scale:
+            gltf_parse_f32_array(node.scale.data, 3, value_token, json);
+            break;
+        }
+        key_token= gltf_skip_value(json, value_token);
+    }
+    if(out) *out= node;
+    return key_token;
+}
+
+typedef enum gltf_json_key {
+    gltf_json_key_unknown,
+    gltf_json_key_accessors,
+    gltf_json_key_asset,
+    gltf_json_key_buffer_views,
+    gltf_json_key_buffers,
+    gltf_json_key_images,
+    gltf_json_key_materials,
+    gltf_json_key_meshes,
+    gltf_json_key_scenes,
+    gltf_json_key_scene,
+    gltf_json_key_nodes,
+    gltf_json_key_max_enum= ~(0u)
+} gltf_json_key;
+
+static const gltf_key gltf_json_key_slots[16]= {
+    [0] = {"scene", 5, gltf_json_key_scene},
+    [1] = {"images", 6, gltf_json_key_images},
+    [3] = {"asset", 5, gltf_json_key_asset},
+    [5] = {"meshes", 6, gltf_json_key_meshes},
+    [6] = {"nodes", 5, gltf_json_key_nodes},
+    [8] = {"accessors", 9, gltf_json_key_accessors},
+    [9] = {"scenes", 6, gltf_json_key_scenes},
+    [10]= {"bufferViews", 11, gltf_json_key_buffer_views},
+    [14]= {"buffers", 7, gltf_json_key_buffers},
+    [15]= {"materials", 9, gltf_json_key_materials},
+};
+static const gltf_key_table gltf_json_keys= {
+    gltf_json_key_slots,
+    0xF06C144Bu,
+    28};
+
+#ifndef NDEBUG
+/* A key stored in any other slot than the one it hashes to is never found,
+ * so debug builds make sure the tables weren't edited by hand. */
+static bool
+gltf_check_key_tables(void) {
+    static const gltf_key_table *tables[]= {
+        &gltf_accessor_keys,
+        &gltf_accessor_types,
+        &gltf_buffer_keys,
+        &gltf_buffer_view_keys,
+        &gltf_pbr_keys,
+        &gltf_material_keys,
+        &gltf_primitive_keys,
+        &gltf_attribute_keys,
+        &gltf_mesh_keys,
+        &gltf_scene_keys,
+        &gltf_node_keys,
+        &gltf_json_keys};
+    for(u32 i= 0; i < sizeof(tables) / sizeof(tables[0]); ++i) {
+        const gltf_key_table *table     = tables[i];
+        u32                   slot_count= 1u << (32 - table->shift);
+        for(u32 slot= 0; slot < slot_count; ++slot) {
+            const gltf_key *key= &table->slots[slot];
+            if(!key->str) continue;
+            if(!key->length || key->str[key->length] != 0 || !key->id)
+                return false;
+            if(gltf_key_slot(table, key->str, key->length) != slot)
+                return false;
+        }
+    }
+    return true;
+}
+#endif
+
+#define GLTF_JSON_SECTION_COUNT (gltf_json_key_nodes + 1)
+
+/* Masks of top-level sections, one bit per gltf_json_key. */
+#define gltf_json_section(key) (1u << (key))
+#define GLTF_JSON_SECTIONS_ALL ((1u << GLTF_JSON_SECTION_COUNT) - 2u)
+#define GLTF_JSON_SECTIONS_GEOMETRY                                            \
+    (gltf_json_section(gltf_json_key_accessors) |                              \
+     gltf_json_section(gltf_json_key_buffer_views) |                           \
+     gltf_json_section(gltf_json_key_buffers) |                                \
+     gltf_json_section(gltf_json_key_meshes))
+
+typedef struct gltf_json_data {
+    u32               accessor_count;
+    u32               buffer_view_count;
+    gltf_buffer_view *buffer_view_list;
+    gltf_accessor    *accessor_list;
+    gltf_buffer       buffer;
+    u32               mesh_count;
+    gltf_mesh        *mesh_list;
+    // Primitives of all meshes in mesh order
+    u32                  primitive_count;
+    gltf_mesh_primitive *primitive_list;
+    u32                  node_count;
+    gltf_node           *node_list;
+    // Value token of every top-level section, they point into the token
+    // arena and the JSON chunk and stay valid until either is reused
+    gltf_json_tokens tokens;
+    jsmntok_t       *section_list[GLTF_JSON_SECTION_COUNT];
+    u32              loaded_sections;
+} gltf_json_data;
+
+typedef enum glb_load_mode {
+    glb_load_mode_read,
+    glb_load_mode_mapped,
+    glb_load_mode_direct,
+    glb_load_mode_stream,
+    glb_load_mode_max_enum= ~(0u)
+} glb_load_mode;
+
+typedef enum gltf_tokenizer {
+    gltf_tokenizer_jsmn,
+    gltf_tokenizer_scan_sse2,
+    gltf_tokenizer_scan_avx2,
+    gltf_tokenizer_max_enum= ~(0u)
+} gltf_tokenizer;
+
+static struct {
+    glb_load_mode      load_mode;
+    gltf_tokenizer     tokenizer;
+    vertex_convert_isa vertex_isa;
+    vertex_format      vertex_format;
+    u32                json_sections;
+    bool               use_cache;
+    bool               use_arena;
+    // 8-bit indices need VK_EXT_index_type_uint8, without it the narrowest
+    // index width is 16 bits
+    bool index_uint8;
+    bool optimize_meshes;
+    bool weld_vertices;
+    bool cluster_culling;
+    bool generate_lods;
+} load_options= {
+    glb_load_mode_read,
+    gltf_tokenizer_jsmn,
+    vertex_convert_isa_scalar,
+    vertex_format_float,
+    GLTF_JSON_SECTIONS_ALL,
+    false,
+    true,
+    true,
+    false,
+    false,
+    false,
+    false};
+
+/* Token storage kept alive across loads, so a JSON chunk is tokenized in a
+ * single pass and the allocation is only paid when a chunk outgrows it. */
+typedef struct gltf_token_arena {
+    jsmntok_t *tokens;
+    u32       *skip_list;
+    u32        capacity;
+} gltf_token_arena;
+
+static gltf_token_arena gltf_token_arenas[JOB_MAX_THREADS];
+
+/* Parsed JSON data of the models opened on each thread, reset once every
+ * model of a load is closed. The parsed structs go into the cache whole,
+ * padding included, so the arenas zero reused memory like the heap
+ * allocator does. */
+static gltf_arena gltf_json_arenas[JOB_MAX_THREADS];
+
+static bool
+gltf_token_arena_reserve(gltf_token_arena *arena, u32 capacity) {
+    if(capacity <= arena->capacity) return true;
+    jsmntok_t *tokens=
+        HeapAlloc(process_heap, 0, sizeof(jsmntok_t) * capacity);
+    u32 *skip_list= HeapAlloc(process_heap, 0, sizeof(u32) * capacity);
+    if(!tokens || !skip_list) {
+        if(tokens) HeapFree(process_heap, 0, tokens);
+        if(skip_list) HeapFree(process_heap, 0, skip_list);
+        return false;
+    }
+    // jsmn resumes from the tokens it has already written
+    for(u32 i= 0; i < arena->capacity; ++i) tokens[i]= arena->tokens[i];
+    if(arena->tokens) HeapFree(process_heap, 0, arena->tokens);
+    if(arena->skip_list) HeapFree(process_heap, 0, arena->skip_list);
+    arena->tokens   = tokens;
+    arena->skip_list= skip_list;
+    arena->capacity = capacity;
+    return true;
+}
+
+static void
+gltf_token_arena_release(gltf_token_arena *arena) {
+    if(arena->tokens) HeapFree(process_heap, 0, arena->tokens);
+    if(arena->skip_list) HeapFree(process_heap, 0, arena->skip_list);
+    arena->tokens   = null;
+    arena->skip_list= null;
+    arena->capacity = 0;
+}
+
+/* Fills the skip list back to front, a value ends where its last child ends
+ * and children are linked before their parent, so every token is visited
+ * once as a child. Keys own their value as a single child. */
+static void
+gltf_link_subtrees(jsmntok_t *tokens, u32 *skip_list, u32 count) {
+    for(u32 i= count; i-- > 0;) {
+        u32 next= i + 1;
+        for(int child= 0; child < tokens[i].size && next < count; ++child)
+            next= skip_list[next];
+        skip_list[i]= next;
+    }
+}
+
+/* Tokenizes `json_data` into `arena`, growing it whenever jsmn runs out of
+ * tokens, and links every subtree for gltf_skip_value(). Returns the token
+ * count, or 0 on malformed input. */
+static int
+gltf_tokenize_json(
+    gltf_token_arena *arena,
+    const char       *json_data,
+    u64               json_length,
+    gltf_tokenizer    tokenizer) {
+    // glTF files run 5 to 8 bytes of JSON per token, compact accessor arrays
+    // being the densest, so a quarter of the length rarely has to grow
+    if(!gltf_token_arena_reserve(arena, (u32)(json_length / 4) + 64)) return 0;
+    jsmn_parser parser;
+    jsmn_init(&parser);
+    for(;;) {
+        int count;
+        if(tokenizer == gltf_tokenizer_jsmn) {
+            count= jsmn_parse(
+                &parser,
+                json_data,
+                json_length,
+                arena->tokens,
+                arena->capacity);
+        } else {
+            // The scanner can't resume, it starts over with the larger arena.
+            // Its open brackets go into the skip list, which is only filled
+            // once the tokens are complete
+            count= json_scan(
+                tokenizer == gltf_tokenizer_scan_avx2 ? json_scan_isa_avx2
+                                                      : json_scan_isa_sse2,
+                json_data,
+                json_length,
+                arena->tokens,
+                arena->skip_list,
+                arena->capacity);
+        }
+        if(count > 0) {
+            gltf_link_subtrees(arena->tokens, arena->skip_list, count);
+            return count;
+        }
+        if(count != JSMN_ERROR_NOMEM) return 0;
+        if(!gltf_token_arena_reserve(arena, arena->capacity * 2)) return 0;
+    }
+}
+
+/* Records the value token of every known top-level key without looking
+ * inside any of them. */
+static void
+gltf_index_json(
+    gltf_json_data *gltf_json,
+    const char     *json_data,
+    jsmntok_t      *tokens,
+    u32            *skip_list,
+    u32             count) {
+    assert(tokens[0].type == JSMN_OBJECT);
+    gltf_json->tokens= (gltf_json_tokens){
+        .json_data= json_data,
+        .tokens   = tokens,
+        .skip_list= skip_list,
+        .count    = count};
+    jsmntok_t *tokens_end= &tokens[count];
+    jsmntok_t *token     = &tokens[1];
+    for(int i= 0; i < tokens[0].size && token + 1 < tokens_end; ++i) {
+        assert(token->type == JSMN_STRING);
+        const char *key_str= &json_data[token->start];
+        u64         key_len= token->end - token->start;
+        u32         key    = gltf_lookup_key(&gltf_json_keys, key_str, key_len);
+        if(key) gltf_json->section_list[key]= &token[1];
+        token= gltf_skip_value(&gltf_json->tokens, &token[1]);
+    }
+}
+
+/* Arrays shorter than this are parsed on the calling thread. */
+#define GLTF_PARALLEL_MIN_ELEMENTS      1024
+#define GLTF_PARALLEL_RANGES_PER_THREAD 4
+
+typedef struct gltf_element_batch {
+    gltf_json_key           key;
+    const gltf_json_tokens *json;
+    jsmntok_t             **range_list;
+    u32                     range_size;
+    u32                     element_count;
+    void                   *out_list;
+} gltf_element_batch;
+
+static void
+gltf_parse_element_range_job(void *user_data, u32 index) {
+    gltf_element_batch *batch= user_data;
+    jsmntok_t          *token= batch->range_list[index];
+    u32                 first= index * batch->range_size;
+    u32                 last = first + batch->range_size;
+    if(last > batch->element_count) last= batch->element_count;
+    for(u32 i= first; i < last; ++i) {
+        if(batch->key == gltf_json_key_accessors) {
+            gltf_accessor *accessor= &((gltf_accessor *)batch->out_list)[i];
+            token= gltf_parse_accessor(accessor, token, batch->json);
+        } else {
+            gltf_buffer_view *buffer_view=
+                &((gltf_buffer_view *)batch->out_list)[i];
+            token= gltf_parse_buffer_view(buffer_view, token, batch->json);
+        }
+    }
+}
+
+/* Parses the accessor or bufferView array `array_token` into `out_list` on
+ * the job system. Element boundaries come from the skip list, and every
+ * range of elements is then parsed by its own job. Returns false for arrays
+ * that are better left to the calling thread. */
+static bool
+gltf_parse_elements_parallel(
+    gltf_json_key           key,
+    jsmntok_t              *array_token,
+    const gltf_json_tokens *json,
+    void                   *out_list) {
+    u32 element_count= array_token->size;
+    u32 thread_count = job_system_thread_count();
+    if(element_count < GLTF_PARALLEL_MIN_ELEMENTS || thread_count < 2)
+        return false;
+    u32 range_count= thread_count * GLTF_PARALLEL_RANGES_PER_THREAD;
+    u32 range_size = (element_count + range_count - 1) / range_count;
+    range_count    = (element_count + range_size - 1) / range_size;
+    jsmntok_t **range_list=
+        HeapAlloc(process_heap, 0, sizeof(jsmntok_t *) * range_count);
+    if(!range_list) return false;
+    jsmntok_t *token= &array_token[1];
+    for(u32 i= 0; i < element_count; ++i) {
+        if(i % range_size == 0) range_list[i / range_size]= token;
+        token= gltf_skip_value(json, token);
+    }
+    gltf_element_batch batch= {
+        .key          = key,
+        .json         = json,
+        .range_list   = range_list,
+        .range_size   = range_size,
+        .element_count= element_count,
+        .out_list     = out_list};
+    job_dispatch(gltf_parse_element_range_job, &batch, range_count);
+    HeapFree(process_heap, 0, range_list);
+    return true;
+}
+
+/* Materializes the indexed sections in `sections` that aren't loaded yet. */
+static void
+gltf_load_sections(
+    gltf_json_data       *gltf_json,
+    u32                   sections,
+    const gltf_allocator *allocator) {
+    const gltf_json_tokens *json= &gltf_json->tokens;
+    if(!json->json_data) return;
+    sections&= ~gltf_json->loaded_sections;
+    for(u32 key= 1; key < GLTF_JSON_SECTION_COUNT; ++key) {
+        jsmntok_t *value_token= gltf_json->section_list[key];
+        if(!(sections & gltf_json_section(key))) continue;
+        // A section the file doesn't have is loaded as empty, otherwise the
+        // cache written from it never covers the requested sections
+        gltf_json->loaded_sections|= gltf_json_section(key);
+        if(!value_token) continue;
+        jsmntok_t *out_token= &value_token[1];
+        switch(key) {
+        case gltf_json_key_accessors:
+            gltf_json->accessor_count= value_token->size;
+            gltf_json->accessor_list = allocator->alloc(
+                allocator->context,
+                sizeof(gltf_accessor) * gltf_json->accessor_count);
+            if(gltf_parse_elements_parallel(
+                   key,
+                   value_token,
+                   json,
+                   gltf_json->accessor_list))
+                break;
+            for(int i= 0; i < value_token->size; ++i) {
+                gltf_accessor *accessor= &gltf_json->accessor_list[i];
+                out_token= gltf_parse_accessor(accessor, out_token, json);
+            }
+            break;
+        case gltf_json_key_buffer_views:
+            gltf_json->buffer_view_count= value_token->size;
+            gltf_json->buffer_view_list = allocator->alloc(
+                allocator->context,
+                sizeof(gltf_buffer_view) * gltf_json->buffer_view_count);
+            if(gltf_parse_elements_parallel(
+                   key,
+                   value_token,
+                   json,
+                   gltf_json->buffer_view_list))
+                break;
+            for(int i= 0; i < value_token->size; ++i) {
+                gltf_buffer_view *buffer_view= &gltf_json->buffer_view_list[i];
+                out_token= gltf_parse_buffer_view(buffer_view, out_token, json);
             }
+            break;
+        case gltf_json_key_buffers:
+            assert(value_token->size == 1);
             for(u32 i= 0; i < value_token->size; ++i) {
-                gltf_mesh_primitive *primitive= null;
-                if(out) primitive= &mesh.primitive_list[i];
                 out_token=
-                    gltf_parse_mesh_primitive(primitive, out_token, json_data);
+                    gltf_parse_buffer(&gltf_json->buffer, out_token, json);
+            }
+            break;
+        case gltf_json_key_images:
+            for(u32 i= 0; i < value_token->size; ++i) {
+                out_token= gltf_parse_image(null, out_token, json);
             }
-            key_token= out_token;
+            break;
+        case gltf_json_key_materials:
+            for(u32 i= 0; i < value_token->size; ++i) {
+                out_token= gltf_parse_material(null, out_token, json);
+            }
+            break;
+        case gltf_json_key_meshes:
+            gltf_json->mesh_count= value_token->size;
+            gltf_json->mesh_list = allocator->alloc(
+                allocator->context,
+                sizeof(gltf_mesh) * gltf_json->mesh_count);
+            // The first pass only counts primitives to size the shared array
+            gltf_json->primitive_count= 0;
+            for(u32 i= 0; i < value_token->size; ++i) {
+                gltf_mesh *mesh      = &gltf_json->mesh_list[i];
+                mesh->first_primitive= gltf_json->primitive_count;
+                out_token= gltf_parse_mesh(mesh, out_token, json, null);
+                gltf_json->primitive_count+= mesh->primitive_count;
+            }
+            gltf_json->primitive_list= allocator->alloc(
+                allocator->context,
+                sizeof(gltf_mesh_primitive) * gltf_json->primitive_count);
+            out_token= &value_token[1];
+            for(u32 i= 0; i < value_token->size; ++i) {
+                out_token= gltf_parse_mesh(
+                    &gltf_json->mesh_list[i],
+                    out_token,
+                    json,
+                    gltf_json->primitive_list);
+            }
+            break;
+        case gltf_json_key_scenes:
+            for(u32 i= 0; i < value_token->size; ++i) {
+                out_token= gltf_parse_scene(null, out_token, json);
+            }
+            break;
+        case gltf_json_key_nodes:
+            gltf_json->node_count= value_token->size;
+            gltf_json->node_list= allocator->alloc(
+                allocator->context,
+                sizeof(gltf_node) * gltf_json->node_count);
+            for(u32 i= 0; i < value_token->size; ++i) {
+                gltf_node *node= &gltf_json->node_list[i];
+                out_token      = gltf_parse_node(node, out_token, json);
+            }
+            break;
+        }
+    }
+}
+
+/* Drops the section index once the tokens or the JSON chunk go away, later
+ * gltf_load_sections() calls become no-ops. */
+static void
+gltf_release_json_index(gltf_json_data *gltf_json) {
+    gltf_json->tokens= (gltf_json_tokens){0};
+    for(u32 key= 0; key < GLTF_JSON_SECTION_COUNT; ++key)
+        gltf_json->section_list[key]= null;
+}
+
+/* Frees everything the loaded sections allocated. */
+static void
+gltf_free_json(gltf_json_data *gltf_json, const gltf_allocator *allocator) {
+    allocator->free(allocator->context, gltf_json->accessor_list);
+    allocator->free(allocator->context, gltf_json->buffer_view_list);
+    allocator->free(allocator->context, gltf_json->mesh_list);
+    allocator->free(allocator->context, gltf_json->primitive_list);
+    allocator->free(allocator->context, gltf_json->node_list);
+}
+
+/* Tokenizes and indexes the JSON chunk and loads the requested sections,
+ * the rest can be loaded later with gltf_load_sections(). */
+static void
+gltf_parse_json(
+    gltf_json_data       *gltf_json,
+    const char           *json_data,
+    u64                   json_length,
+    gltf_token_arena     *arena,
+    u32                   sections,
+    const gltf_allocator *allocator) {
+    int count= gltf_tokenize_json(
+        arena,
+        json_data,
+        json_length,
+        load_options.tokenizer);
+    if(!count) return;
+    gltf_index_json(
+        gltf_json,
+        json_data,
+        arena->tokens,
+        arena->skip_list,
+        count);
+    gltf_load_sections(gltf_json, sections, allocator);
+}
+
+/* ReadFile takes a 32-bit size, larger reads are split into parts that are
+ * all in flight at once. */
+#define WIN32_READ_PART_SIZE (1ull << 30)
+#define WIN32_READ_MAX_PARTS 16
+
+/* In-flight read on a handle opened with FILE_FLAG_OVERLAPPED. Each part owns
+ * its event so several reads can be outstanding on the same handle. */
+typedef struct win32_async_read {
+    OVERLAPPED overlapped[WIN32_READ_MAX_PARTS];
+    DWORD      part_size[WIN32_READ_MAX_PARTS];
+    u32        part_count;
+    bool       failed;
+} win32_async_read;
+
+static bool
+win32_wait_read(HANDLE file_handle, win32_async_read *read) {
+    bool res= !read->failed;
+    for(u32 i= 0; i < read->part_count; ++i) {
+        DWORD bytes_read= 0u;
+        if(!GetOverlappedResult(
+               file_handle,
+               &read->overlapped[i],
+               &bytes_read,
+               TRUE) ||
+           bytes_read != read->part_size[i])
+            res= false;
+        CloseHandle(read->overlapped[i].hEvent);
+    }
+    read->part_count= 0;
+    return res;
+}
+
+static bool
+win32_begin_read(
+    HANDLE            file_handle,
+    void             *buffer,
+    u64               size,
+    u64               offset,
+    win32_async_read *out) {
+    out->part_count= 0;
+    out->failed    = size > WIN32_READ_PART_SIZE * WIN32_READ_MAX_PARTS;
+    for(u64 done= 0; !out->failed && done < size;) {
+        u64 part_size= size - done;
+        if(part_size > WIN32_READ_PART_SIZE) part_size= WIN32_READ_PART_SIZE;
+        OVERLAPPED *overlapped= &out->overlapped[out->part_count];
+        *overlapped           = (OVERLAPPED){0};
+        overlapped->Offset    = (DWORD)(offset + done);
+        overlapped->OffsetHigh= (DWORD)((offset + done) >> 32);
+        overlapped->hEvent    = CreateEvent(NULL, TRUE, FALSE, NULL);
+        if(!overlapped->hEvent) {
+            out->failed= true;
+            break;
+        }
+        if(!ReadFile(
+               file_handle,
+               (u8 *)buffer + done,
+               (DWORD)part_size,
+               NULL,
+               overlapped) &&
+           GetLastError() != ERROR_IO_PENDING) {
+            CloseHandle(overlapped->hEvent);
+            out->failed= true;
+            break;
         }
-        value_token= key_token + 1;
+        out->part_size[out->part_count++]= (DWORD)part_size;
+        done+= part_size;
+    }
+    if(out->failed) {
+        win32_wait_read(file_handle, out);
+        return false;
+    }
+    return true;
+}
+
+static bool
+win32_read(HANDLE file_handle, void *buffer, u64 size, u64 offset) {
+    win32_async_read read;
+    if(!win32_begin_read(file_handle, buffer, size, offset, &read))
+        return false;
+    return win32_wait_read(file_handle, &read);
+}
+
+/* Synchronous write at `offset`, split into parts like reads to stay below
+ * the 32-bit WriteFile size. */
+static bool
+win32_write(HANDLE file_handle, const void *buffer, u64 size, u64 offset) {
+    for(u64 done= 0; done < size;) {
+        u64 part_size= size - done;
+        if(part_size > WIN32_READ_PART_SIZE) part_size= WIN32_READ_PART_SIZE;
+        OVERLAPPED overlapped   = {0};
+        DWORD      bytes_written= 0u;
+        overlapped.Offset       = (DWORD)(offset + done);
+        overlapped.OffsetHigh   = (DWORD)((offset + done) >> 32);
+        if(!WriteFile(
+               file_handle,
+               (const u8 *)buffer + done,
+               (DWORD)part_size,
+               &bytes_written,
+               &overlapped) ||
+           bytes_written != part_size)
+            return false;
+        done+= part_size;
+    }
+    return true;
+}
+
+// Simplified levels a primitive can have besides its full index range
+#define MESH_LOD_COUNT 4u
+
+/* One simplified index range, first_index is relative to the index_offset
+ * of its primitive and error is the distance the simplification moved the
+ * surface by at most, in the space of the vertex positions. */
+typedef struct mesh_lod_t {
+    u32 first_index;
+    u32 index_count;
+    f32 error;
+} mesh_lod_t;
+
+/* Draw range of one primitive in the shared buffers. Positions are drawn as
+ * pos_offset + pos_scale * pos, which undoes the quantization of the compact
+ * vertex formats and is the identity for float vertices. Every primitive
+ * has its own index width, index_offset counts elements of that width from
+ * the start of the index buffer. Clusters index the shared cluster list and
+ * are only set on the draw list, their bounds are in quantized space. Levels
+ * of detail follow the full index range in the same buffer range, coarsest
+ * last, and bounds is the sphere the renderer measures them against. */
+typedef struct mesh_primitive_t {
+    u32        vertex_count;
+    u32        vertex_offset;
+    u32        index_count;
+    u32        index_offset;
+    u32        index_size; // 1, 2 or 4 bytes
+    vec3       pos_offset;
+    vec3       pos_scale;
+    u32        first_cluster;
+    u32        cluster_count;
+    u32        lod_count;
+    mesh_lod_t lod_list[MESH_LOD_COUNT];
+    vec4       bounds; // center and radius in the space of the positions
+} mesh_primitive_t;
+
+static u32
+glb_vertex_size(void) {
+    return vertex_format_size(load_options.vertex_format);
+}
+
+static u32
+glb_min_index_size(void) {
+    return load_options.index_uint8 ? 1 : 2;
+}
+
+static u32
+glb_vertex_cache_size(void) {
+    return load_options.optimize_meshes ? MESH_VERTEX_CACHE_SIZE : 0;
+}
+
+/* Index budget of a level of detail, every level halves the triangles of
+ * the one before. */
+static u32
+glb_lod_index_count(u32 index_count, u32 level) {
+    return (index_count / 3 >> (level + 1)) * 3;
+}
+
+/* Indices to reserve for a primitive, its levels of detail go right behind
+ * the full range and keep their budget even when they come out smaller or
+ * not at all. */
+static u32
+glb_index_capacity(const gltf_mesh_primitive *gltf_primitive, u32 index_count) {
+    if(!load_options.generate_lods || gltf_primitive->mode != 4)
+        return index_count;
+    u32 capacity= index_count;
+    for(u32 level= 0; level < MESH_LOD_COUNT; ++level)
+        capacity+= glb_lod_index_count(index_count, level);
+    return capacity;
+}
+
+/* Converts packed POSITION and NORMAL data of `primitive` into the vertex
+ * format of the load. */
+static void
+glb_convert_vertices(
+    const mesh_primitive_t *primitive,
+    const vec3             *pos_data,
+    const vec3             *nrm_data,
+    u32                     count,
+    u8                     *vertices) {
+    if(load_options.vertex_format == vertex_format_float) {
+        vertex_convert(
+            load_options.vertex_isa,
+            pos_data,
+            nrm_data,
+            count,
+            (vertex *)vertices);
+    } else {
+        vertex_quantize(
+            load_options.vertex_format,
+            pos_data,
+            nrm_data,
+            count,
+            &primitive->pos_offset,
+            &primitive->pos_scale,
+            vertices);
+    }
+}
+
+/* Element layout of an accessor, false for types and component types glTF
+ * doesn't define. */
+static bool
+glb_accessor_layout(
+    const gltf_json_data *gltf_json,
+    const gltf_accessor  *accessor,
+    accessor_layout      *out) {
+    if(accessor->buffer_view >= gltf_json->buffer_view_count) return false;
+    *out= (accessor_layout){
+        .rows       = 1,
+        .columns    = 1,
+        .normalized = accessor->normalized,
+        .byte_stride= gltf_json->buffer_view_list[accessor->buffer_view]
+                          .byte_stride};
+    switch(accessor->component_type) {
+    case gltf_accessor_component_sbyte:
+        out->component= accessor_component_s8;
+        break;
+    case gltf_accessor_component_ubyte:
+        out->component= accessor_component_u8;
+        break;
+    case gltf_accessor_component_sshort:
+        out->component= accessor_component_s16;
+        break;
+    case gltf_accessor_component_ushort:
+        out->component= accessor_component_u16;
+        break;
+    case gltf_accessor_component_uint:
+        out->component= accessor_component_u32;
+        break;
+    case gltf_accessor_component_float:
+        out->component= accessor_component_f32;
+        break;
+    default: return false;
+    }
+    switch(accessor->type) {
+    case gltf_accessor_scalar: break;
+    case gltf_accessor_vec2: out->rows= 2; break;
+    case gltf_accessor_vec3: out->rows= 3; break;
+    case gltf_accessor_vec4: out->rows= 4; break;
+    case gltf_accessor_mat2: out->rows= out->columns= 2; break;
+    case gltf_accessor_mat3: out->rows= out->columns= 3; break;
+    case gltf_accessor_mat4: out->rows= out->columns= 4; break;
+    default: return false;
+    }
+    return true;
+}
+
+/* Decoder of the accessor at `accessor_index` and the offset of its first
+ * element into the BIN chunk. */
+static bool
+glb_accessor_decoder(
+    const gltf_json_data *gltf_json,
+    u32                   accessor_index,
+    accessor_target       target,
+    accessor_decoder     *out_decoder,
+    u64                  *out_offset) {
+    if(accessor_index >= gltf_json->accessor_count) return false;
+    const gltf_accessor *accessor= &gltf_json->accessor_list[accessor_index];
+    accessor_layout      layout;
+    if(!glb_accessor_layout(gltf_json, accessor, &layout) ||
+       !accessor_decoder_make(
+           &layout,
+           target,
+           load_options.vertex_isa,
+           out_decoder))
+        return false;
+    *out_offset= gltf_json->buffer_view_list[accessor->buffer_view]
+                     .byte_offset +
+                 accessor->byte_offset;
+    return true;
+}
+
+/* How the raw POSITION, NORMAL and index elements of a primitive decode,
+ * offsets are relative to the start of the BIN chunk. */
+typedef struct glb_primitive_source {
+    accessor_decoder pos;
+    accessor_decoder nrm;
+    accessor_decoder idx;
+    u64              pos_offset;
+    u64              nrm_offset;
+    u64              idx_offset;
+    // No NORMAL attribute, the positions are converted as placeholder
+    // normals until glb_model_generate_normals() replaces them
+    bool generate_normals;
+    // No indices, the primitive draws its vertices in order and gets the
+    // indices 0, 1, 2... written for it, `idx` only has its target size
+    bool sequential_indices;
+} glb_primitive_source;
+
+/* Elements decoded per pass when the attributes aren't packed float3, a
+ * POSITION and NORMAL block takes 3 KB of stack. */
+#define GLB_DECODE_BLOCK 128u
+
+/* Converts POSITION and NORMAL elements of any accessor layout into the
+ * vertex format of the load, `pos_data` and `nrm_data` point at the first
+ * element. Packed float3 sources skip the decode. */
+static void
+glb_decode_vertices(
+    const mesh_primitive_t     *primitive,
+    const glb_primitive_source *source,
+    const u8                   *pos_data,
+    const u8                   *nrm_data,
+    u32                         count,
+    u8                         *vertices) {
+    if(source->pos.passthrough && source->nrm.passthrough) {
+        glb_convert_vertices(
+            primitive,
+            (const vec3 *)pos_data,
+            (const vec3 *)nrm_data,
+            count,
+            vertices);
+        return;
+    }
+    u32 vertex_size= glb_vertex_size();
+    for(u32 first= 0; first < count; first+= GLB_DECODE_BLOCK) {
+        u32 block_count= count - first;
+        if(block_count > GLB_DECODE_BLOCK) block_count= GLB_DECODE_BLOCK;
+        vec3 pos_block[GLB_DECODE_BLOCK];
+        vec3 nrm_block[GLB_DECODE_BLOCK];
+        accessor_decode(
+            &source->pos,
+            pos_data + (u64)source->pos.stride * first,
+            block_count,
+            pos_block);
+        accessor_decode(
+            &source->nrm,
+            nrm_data + (u64)source->nrm.stride * first,
+            block_count,
+            nrm_block);
+        glb_convert_vertices(
+            primitive,
+            pos_block,
+            nrm_block,
+            block_count,
+            vertices + (u64)vertex_size * first);
+    }
+}
+
+/* Upper bound on vertices converted per pass of glb_read_vertices_direct, it
+ * keeps every read comfortably below the 4 GB ReadFile limit. */
+#define GLB_DIRECT_READ_WINDOW (1u << 16)
+
+/* Reads tightly packed float3 POSITION and NORMAL data straight into the
+ * mapped staging memory of a primitive and widens it to `vertex` in place.
+ * Each pass reads the raw attributes of the top of the unconverted range into
+ * the unwritten slots right below it, which is possible while the pass covers
+ * at most 4/7 of the remaining vertices (24 raw bytes per 32 byte vertex). */
+static bool
+glb_read_vertices_direct(
+    HANDLE  file_handle,
+    u64     pos_file_offset,
+    u64     nrm_file_offset,
+    u32     vertex_count,
+    vertex *vertices) {
+    u32 remaining= vertex_count;
+    while(remaining) {
+        u32 count= (u32)(((u64)remaining * 4) / 7);
+        if(count > GLB_DIRECT_READ_WINDOW) count= GLB_DIRECT_READ_WINDOW;
+        // A single vertex fits its own raw data and converts in registers
+        if(!count) count= remaining;
+        u32 first= remaining - count;
+        u8 *raw_data=
+            (u8 *)&vertices[first] - (first ? sizeof(vec3) * 2 * count : 0);
+        const vec3      *pos_data= (const vec3 *)raw_data;
+        const vec3      *nrm_data= (const vec3 *)raw_data + count;
+        win32_async_read pos_read, nrm_read;
+        bool             res= win32_begin_read(
+            file_handle,
+            raw_data,
+            sizeof(vec3) * count,
+            pos_file_offset + (u64)sizeof(vec3) * first,
+            &pos_read);
+        res= win32_begin_read(
+                 file_handle,
+                 raw_data + sizeof(vec3) * count,
+                 sizeof(vec3) * count,
+                 nrm_file_offset + (u64)sizeof(vec3) * first,
+                 &nrm_read) &&
+             res;
+        res= win32_wait_read(file_handle, &pos_read) && res;
+        res= win32_wait_read(file_handle, &nrm_read) && res;
+        if(!res) return false;
+        vertex_convert(
+            load_options.vertex_isa,
+            pos_data,
+            nrm_data,
+            count,
+            &vertices[first]);
+        remaining= first;
+    }
+    return true;
+}
+
+/* Size of each of the two buffers the BIN chunk is streamed through. While
+ * one window is being converted the read of the next one is in flight. */
+#define GLB_STREAM_WINDOW_SIZE (16ull << 20)
+#define GLB_STREAM_MAX_SOURCES 4
+
+typedef struct glb_stream {
+    HANDLE file_handle;
+    u8    *windows[2];
+} glb_stream;
+
+/* Element array of an accessor, streamed window by window in parallel with
+ * the other sources of the same call. Elements keep their stride in the
+ * window, so interleaved attributes arrive with their neighbours. */
+typedef struct glb_stream_source {
+    u64                     file_offset;
+    const accessor_decoder *decoder;
+} glb_stream_source;
+
+typedef void (*glb_stream_func)(
+    void            *user_data,
+    const u8 *const *source_data,
+    u32              first,
+    u32              count);
+
+static bool
+glb_stream_open(HANDLE file_handle, glb_stream *out) {
+    out->file_handle= file_handle;
+    out->windows[0] = HeapAlloc(process_heap, 0, GLB_STREAM_WINDOW_SIZE * 2);
+    out->windows[1] = out->windows[0] + GLB_STREAM_WINDOW_SIZE;
+    return out->windows[0] != NULL;
+}
+
+static void
+glb_stream_close(glb_stream *stream) {
+    HeapFree(process_heap, 0, stream->windows[0]);
+    *stream= (glb_stream){0};
+}
+
+static bool
+glb_stream_begin_window(
+    glb_stream              *stream,
+    u32                      slot,
+    const glb_stream_source *sources,
+    u32                      source_count,
+    u32                      window_elements,
+    u32                      first,
+    u32                      count,
+    win32_async_read        *reads) {
+    u8  *window= stream->windows[slot];
+    bool res   = true;
+    for(u32 i= 0; i < source_count; ++i) {
+        const accessor_decoder *decoder= sources[i].decoder;
+        res= win32_begin_read(
+                 stream->file_handle,
+                 window,
+                 accessor_source_size(decoder, count),
+                 sources[i].file_offset + (u64)decoder->stride * first,
+                 &reads[i]) &&
+             res;
+        window+= (u64)decoder->stride * window_elements;
+    }
+    return res;
+}
+
+static bool
+glb_stream_wait_window(
+    glb_stream       *stream,
+    u32               source_count,
+    win32_async_read *reads) {
+    bool res= true;
+    for(u32 i= 0; i < source_count; ++i)
+        res= win32_wait_read(stream->file_handle, &reads[i]) && res;
+    return res;
+}
+
+/* Streams `element_count` elements of every source through the two windows
+ * and hands each window to `func`, so at most 2 * GLB_STREAM_WINDOW_SIZE
+ * bytes of the BIN chunk are resident at a time. */
+static bool
+glb_stream_elements(
+    glb_stream              *stream,
+    const glb_stream_source *sources,
+    u32                      source_count,
+    u32                      element_count,
+    glb_stream_func          func,
+    void                    *user_data) {
+    assert(source_count <= GLB_STREAM_MAX_SOURCES);
+    u32 stride= 0;
+    for(u32 i= 0; i < source_count; ++i) stride+= sources[i].decoder->stride;
+    if(!element_count || !stride) return true;
+    u32 window_elements= (u32)(GLB_STREAM_WINDOW_SIZE / stride);
+    win32_async_read reads[2][GLB_STREAM_MAX_SOURCES];
+    u32              count= element_count < window_elements ? element_count :
+                                                              window_elements;
+    bool res= glb_stream_begin_window(
+        stream,
+        0,
+        sources,
+        source_count,
+        window_elements,
+        0,
+        count,
+        reads[0]);
+    for(u32 first= 0, slot= 0; first < element_count; slot^= 1) {
+        u32 next_first= first + count;
+        u32 next_count= element_count - next_first;
+        if(next_count > window_elements) next_count= window_elements;
+        bool next_pending= res && next_count;
+        if(next_pending) {
+            res= glb_stream_begin_window(
+                stream,
+                slot ^ 1,
+                sources,
+                source_count,
+                window_elements,
+                next_first,
+                next_count,
+                reads[slot ^ 1]);
+        }
+        res= glb_stream_wait_window(stream, source_count, reads[slot]) && res;
+        if(!res) {
+            if(next_pending)
+                glb_stream_wait_window(stream, source_count, reads[slot ^ 1]);
+            return false;
+        }
+        const u8 *source_data[GLB_STREAM_MAX_SOURCES];
+        const u8 *window= stream->windows[slot];
+        for(u32 i= 0; i < source_count; ++i) {
+            source_data[i]= window;
+            window+= (u64)sources[i].decoder->stride * window_elements;
+        }
+        func(user_data, source_data, first, count);
+        first= next_first;
+        count= next_count;
+    }
+    return true;
+}
+
+typedef struct glb_stream_vertex_target {
+    const mesh_primitive_t     *primitive;
+    const glb_primitive_source *source;
+    u8                         *vertices;
+} glb_stream_vertex_target;
+
+static void
+glb_stream_convert_vertices(
+    void            *user_data,
+    const u8 *const *source_data,
+    u32              first,
+    u32              count) {
+    const glb_stream_vertex_target *target= user_data;
+    glb_decode_vertices(
+        target->primitive,
+        target->source,
+        source_data[0],
+        source_data[1],
+        count,
+        target->vertices + (u64)glb_vertex_size() * first);
+}
+
+typedef struct glb_stream_index_target {
+    const accessor_decoder *decoder;
+    u8                     *indices;
+} glb_stream_index_target;
+
+static void
+glb_stream_decode_indices(
+    void            *user_data,
+    const u8 *const *source_data,
+    u32              first,
+    u32              count) {
+    const glb_stream_index_target *target= user_data;
+    accessor_decode(
+        target->decoder,
+        source_data[0],
+        count,
+        target->indices + (u64)target->decoder->target_size * first);
+}
+
+/* The chunk length field is 32-bit, so a BIN chunk running to the end of a
+ * file larger than 4 GB has its length truncated. The full length is
+ * recovered when the stored value matches the bytes left in the file. */
+static u64
+glb_chunk_length(u32 length, u64 chunk_data_offset, u64 file_size) {
+    if(chunk_data_offset > file_size) return length;
+    u64 remaining= file_size - chunk_data_offset;
+    if(remaining > length && (u32)remaining == length) return remaining;
+    return length;
+}
+
+/* Read-only view of a memory mapped .glb, the chunk pointers point directly
+ * into the mapping so nothing is copied or zero-filled before parsing. */
+typedef struct glb_mapped_file {
+    HANDLE      mapping_handle;
+    const u8   *view;
+    u64         size;
+    const char *json_data;
+    u64         json_length;
+    const u8   *bin_data;
+    u64         bin_length;
+} glb_mapped_file;
+
+static bool
+glb_map_file(HANDLE file_handle, glb_mapped_file *out) {
+    LARGE_INTEGER file_size= {0};
+    if(!GetFileSizeEx(file_handle, &file_size)) return false;
+    if(file_size.QuadPart <
+       sizeof(glb_header) + sizeof(glb_chunk_header) * 2)
+        return false;
+    HANDLE mapping_handle=
+        CreateFileMapping(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if(!mapping_handle) return false;
+    const u8 *view= MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+    if(!view) {
+        CloseHandle(mapping_handle);
+        return false;
+    }
+    u64                     size  = file_size.QuadPart;
+    const glb_header       *header= (const glb_header *)view;
+    const glb_chunk_header *json_chunk=
+        (const glb_chunk_header *)(view + sizeof(glb_header));
+    u64 json_chunk_offset= sizeof(glb_header) + sizeof(glb_chunk_header);
+    u64 bin_chunk_offset = json_chunk_offset + json_chunk->length;
+    if(header->magic != 0x46546C67u || json_chunk->type != glb_chunk_json ||
+       bin_chunk_offset + sizeof(glb_chunk_header) > size) {
+        UnmapViewOfFile(view);
+        CloseHandle(mapping_handle);
+        return false;
+    }
+    const glb_chunk_header *bin_chunk=
+        (const glb_chunk_header *)(view + bin_chunk_offset);
+    bin_chunk_offset+= sizeof(glb_chunk_header);
+    u64 bin_length= glb_chunk_length(bin_chunk->length, bin_chunk_offset, size);
+    if(bin_chunk->type != glb_chunk_bin ||
+       bin_chunk_offset + bin_length > size) {
+        UnmapViewOfFile(view);
+        CloseHandle(mapping_handle);
+        return false;
+    }
+    out->mapping_handle= mapping_handle;
+    out->view          = view;
+    out->size          = size;
+    out->json_data     = (const char *)(view + json_chunk_offset);
+    out->json_length   = json_chunk->length;
+    out->bin_data      = view + bin_chunk_offset;
+    out->bin_length    = bin_length;
+    return true;
+}
+
+static void
+glb_unmap_file(glb_mapped_file *file) {
+    UnmapViewOfFile(file->view);
+    CloseHandle(file->mapping_handle);
+    *file= (glb_mapped_file){0};
+}
+
+/*============================================================================*/
+/* Scene Cache                                                                */
+/*============================================================================*/
+#define GLB_CACHE_MAGIC 0x43424C47u
+// Bump whenever a cached struct or the vertex format changes
+#define GLB_CACHE_VERSION 13u
+#define GLB_CACHE_ALIGN   64ull
+
+typedef enum glb_cache_section {
+    glb_cache_section_accessors,
+    glb_cache_section_buffer_views,
+    glb_cache_section_meshes,
+    glb_cache_section_gltf_primitives,
+    glb_cache_section_nodes,
+    glb_cache_section_primitives,
+    glb_cache_section_vertices,
+    glb_cache_section_indices,
+    glb_cache_section_count,
+    glb_cache_section_max_enum= ~(0u)
+} glb_cache_section;
+
+/* A cache file holds everything a load produces for one .glb: the parsed
+ * glTF arrays, the mesh_primitive_t list with offsets relative to the model
+ * and the converted vertex and index streams exactly as they go into
+ * staging. Sections are addressed by file offset, so the file works
+ * wherever it is mapped, and it is keyed by a hash of the whole source
+ * file. */
+typedef struct glb_cache_header {
+    u32         magic;
+    u32         version;
+    u64         source_hash;
+    u64         source_size;
+    u32         vertex_format;
+    u32         vertex_size;
+    u32         index_size; // narrowest index width the load allowed
+    u32         vertex_cache_size; // 0 for triangles in source order
+    u32         welded; // 1 when duplicate vertices were merged
+    u32         lods; // 1 when levels of detail follow the index ranges
+    u32         json_sections;
+    gltf_buffer buffer;
+    u64         section_offset[glb_cache_section_count];
+    u64         section_size[glb_cache_section_count];
+} glb_cache_header;
+
+typedef struct glb_cache {
+    HANDLE                  mapping_handle;
+    const u8               *view;
+    const glb_cache_header *header;
+} glb_cache;
+
+/* Hashes the whole file through a read-only view. */
+static bool
+glb_hash_file(HANDLE file_handle, u64 *out_hash, u64 *out_size) {
+    LARGE_INTEGER file_size= {0};
+    if(!GetFileSizeEx(file_handle, &file_size) || !file_size.QuadPart)
+        return false;
+    HANDLE mapping_handle=
+        CreateFileMapping(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if(!mapping_handle) return false;
+    const u8 *view= MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+    if(view) {
+        *out_hash= hash_bytes(view, file_size.QuadPart, 0);
+        *out_size= file_size.QuadPart;
+        UnmapViewOfFile(view);
+    }
+    CloseHandle(mapping_handle);
+    return view != null;
+}
+
+/* Maps the cache file at `cache_path` if it was written for this exact
+ * source, with at least the requested JSON sections and the current vertex
+ * and index formats. The source is only hashed once everything else
+ * matches, a missing or stale cache costs no read of it. */
+static bool
+glb_cache_open(
+    LPCWSTR    cache_path,
+    HANDLE     source_handle,
+    u32        json_sections,
+    glb_cache *out) {
+    HANDLE file_handle= CreateFile(
+        cache_path,
+        FILE_READ_ATTRIBUTES | FILE_READ_DATA,
+        FILE_SHARE_READ,
+        NULL,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        NULL);
+    if(file_handle == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER file_size     = {0};
+    LARGE_INTEGER source_size   = {0};
+    HANDLE        mapping_handle= NULL;
+    const u8     *view          = null;
+    if(GetFileSizeEx(file_handle, &file_size) &&
+       (u64)file_size.QuadPart >= sizeof(glb_cache_header)) {
+        mapping_handle=
+            CreateFileMapping(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    }
+    if(mapping_handle)
+        view= MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+    // The view keeps the file open
+    CloseHandle(file_handle);
+    const glb_cache_header *header= (const glb_cache_header *)view;
+    bool res= view && GetFileSizeEx(source_handle, &source_size) &&
+              header->magic == GLB_CACHE_MAGIC &&
+              header->version == GLB_CACHE_VERSION &&
+              header->source_size == (u64)source_size.QuadPart &&
+              header->vertex_format == load_options.vertex_format &&
+              header->vertex_size == glb_vertex_size() &&
+              header->index_size == glb_min_index_size() &&
+              header->vertex_cache_size == glb_vertex_cache_size() &&
+              header->welded == (u32)load_options.weld_vertices &&
+              header->lods == (u32)load_options.generate_lods &&
+              !(json_sections & ~header->json_sections);
+    for(u32 i= 0; res && i < glb_cache_section_count; ++i) {
+        res= header->section_offset[i] % GLB_CACHE_ALIGN == 0 &&
+             header->section_offset[i] <= (u64)file_size.QuadPart &&
+             header->section_size[i] <=
+                 (u64)file_size.QuadPart - header->section_offset[i];
+    }
+    u64 source_hash= 0, hashed_size= 0;
+    res= res && glb_hash_file(source_handle, &source_hash, &hashed_size) &&
+         header->source_hash == source_hash;
+    if(!res) {
+        if(view) UnmapViewOfFile(view);
+        if(mapping_handle) CloseHandle(mapping_handle);
+        return false;
+    }
+    out->mapping_handle= mapping_handle;
+    out->view          = view;
+    out->header        = header;
+    return true;
+}
+
+static void
+glb_cache_close(glb_cache *cache) {
+    UnmapViewOfFile(cache->view);
+    CloseHandle(cache->mapping_handle);
+    *cache= (glb_cache){0};
+}
+
+/* Writes the sections at aligned offsets and the header last, so a file cut
+ * short by a failed write never validates. */
+static bool
+glb_cache_write(
+    LPCWSTR            cache_path,
+    glb_cache_header  *header,
+    const void *const *section_list) {
+    HANDLE file_handle= CreateFile(
+        cache_path,
+        GENERIC_WRITE,
+        0,
+        NULL,
+        CREATE_ALWAYS,
+        FILE_ATTRIBUTE_NORMAL,
+        NULL);
+    if(file_handle == INVALID_HANDLE_VALUE) return false;
+    u64 offset= sizeof(glb_cache_header);
+    for(u32 i= 0; i < glb_cache_section_count; ++i) {
+        offset= (offset + GLB_CACHE_ALIGN - 1) & ~(GLB_CACHE_ALIGN - 1);
+        header->section_offset[i]= offset;
+        offset+= header->section_size[i];
+    }
+    bool res= true;
+    for(u32 i= 0; res && i < glb_cache_section_count; ++i) {
+        res= win32_write(
+            file_handle,
+            section_list[i],
+            header->section_size[i],
+            header->section_offset[i]);
+    }
+    res= res && win32_write(file_handle, header, sizeof(glb_cache_header), 0);
+    CloseHandle(file_handle);
+    if(!res) DeleteFile(cache_path);
+    return res;
+}
+
+/* One .glb on its way from disk into the shared vertex and index buffers.
+ * Models are opened and converted on the job system, so everything a load
+ * needs lives here instead of on the stack of main(). */
+typedef struct glb_model {
+    LPCWSTR           file_path;
+    HANDLE            file_handle;
+    glb_mapped_file   mapped_file;
+    u64               bin_data_offset;
+    u64               bin_length;
+    void             *bin_chunk_buffer;
+    win32_async_read  bin_chunk_read;
+    gltf_allocator    allocator;
+    gltf_json_data    gltf_json;
+    u32               primitive_count;
+    mesh_primitive_t *primitive_list;
+    u64               vertex_count;
+    u64               index_size; // bytes, a multiple of 4
+    LPWSTR            cache_path;
+    glb_cache         cache;
+    u32               first_primitive;
+    u64               first_vertex;
+    u64               index_offset; // bytes into the index buffer
+    bool              loaded;
+    // Parallel to primitive_list, null for models loaded from the cache
+    glb_primitive_source *source_list;
+    // Every POSITION and NORMAL source is already float3 and tightly packed
+    bool packed_vertices;
+    // Vertex cache statistics of the triangle lists before and after they
+    // were optimized, zero for models that weren't
+    mesh_cache_stats cache_stats[2];
+    // Converted and welded vertices followed by the indices, null for
+    // models this load didn't weld
+    u8 *welded_data;
+    // Vertex counts of the primitives before welding, null with welded_data
+    u32 *unwelded_vertex_counts;
+    // Clusters of all primitives in order and the number each primitive
+    // has, they outlive glb_model_close until they are merged into the draw
+    // list
+    mesh_cluster_list clusters;
+    void             *cluster_memory;
+    u32              *cluster_counts;
+    // Triangles of the primitives this load simplified at every level, the
+    // full one first, and the time the simplification took
+    u64 lod_triangle_counts[MESH_LOD_COUNT + 1];
+    f64 lod_seconds;
+    // Vertices and triangles of the primitives this load generated normals
+    // for, and the time that took
+    u64 normal_vertex_count;
+    u64 normal_triangle_count;
+    f64 normal_seconds;
+} glb_model;
+
+static void
+glb_model_close(glb_model *model) {
+    if(model->bin_chunk_read.part_count)
+        win32_wait_read(model->file_handle, &model->bin_chunk_read);
+    if(model->mapped_file.view) glb_unmap_file(&model->mapped_file);
+    if(model->bin_chunk_buffer)
+        HeapFree(process_heap, 0, model->bin_chunk_buffer);
+    model->bin_chunk_buffer= NULL;
+    if(model->file_handle && model->file_handle != INVALID_HANDLE_VALUE)
+        CloseHandle(model->file_handle);
+    model->file_handle= NULL;
+    if(model->cache.view) {
+        // Everything below points into the cache mapping
+        glb_cache_close(&model->cache);
+    } else {
+        gltf_free_json(&model->gltf_json, &model->allocator);
+        if(model->primitive_list)
+            HeapFree(process_heap, 0, model->primitive_list);
+    }
+    if(model->source_list) HeapFree(process_heap, 0, model->source_list);
+    if(model->welded_data) HeapFree(process_heap, 0, model->welded_data);
+    if(model->unwelded_vertex_counts)
+        HeapFree(process_heap, 0, model->unwelded_vertex_counts);
+    model->gltf_json             = (gltf_json_data){0};
+    model->primitive_list        = null;
+    model->source_list           = null;
+    model->welded_data           = null;
+    model->unwelded_vertex_counts= null;
+    if(model->cache_path) HeapFree(process_heap, 0, model->cache_path);
+    model->cache_path= null;
+}
+
+/* Points the model at the sections of a mapped cache file. */
+static void
+glb_model_load_cache(glb_model *model) {
+    const glb_cache_header *header   = model->cache.header;
+    gltf_json_data         *gltf_json= &model->gltf_json;
+#define cache_section(type, section)                                           \
+    ((type *)(model->cache.view + header->section_offset[section]))
+#define cache_count(type, section)                                             \
+    (header->section_size[section] / sizeof(type))
+    gltf_json->accessor_list=
+        cache_section(gltf_accessor, glb_cache_section_accessors);
+    gltf_json->accessor_count=
+        (u32)cache_count(gltf_accessor, glb_cache_section_accessors);
+    gltf_json->buffer_view_list=
+        cache_section(gltf_buffer_view, glb_cache_section_buffer_views);
+    gltf_json->buffer_view_count=
+        (u32)cache_count(gltf_buffer_view, glb_cache_section_buffer_views);
+    gltf_json->mesh_list= cache_section(gltf_mesh, glb_cache_section_meshes);
+    gltf_json->mesh_count=
+        (u32)cache_count(gltf_mesh, glb_cache_section_meshes);
+    gltf_json->primitive_list=
+        cache_section(gltf_mesh_primitive, glb_cache_section_gltf_primitives);
+    gltf_json->primitive_count= (u32)cache_count(
+        gltf_mesh_primitive,
+        glb_cache_section_gltf_primitives);
+    gltf_json->node_list= cache_section(gltf_node, glb_cache_section_nodes);
+    gltf_json->node_count=
+        (u32)cache_count(gltf_node, glb_cache_section_nodes);
+    gltf_json->buffer         = header->buffer;
+    gltf_json->loaded_sections= header->json_sections;
+    model->primitive_list=
+        cache_section(mesh_primitive_t, glb_cache_section_primitives);
+    model->primitive_count=
+        (u32)cache_count(mesh_primitive_t, glb_cache_section_primitives);
+    model->vertex_count= header->section_size[glb_cache_section_vertices] /
+                         header->vertex_size;
+    model->index_size  = header->section_size[glb_cache_section_indices];
+#undef cache_count
+#undef cache_section
+}
+
+/* Saves the load result of a model that was converted from its .glb,
+ * `vertices` and `indices` are its range of the staging memory. The source
+ * is hashed here, after the conversion, so a load without a cache to hit
+ * reads it only once up front. A failed write only costs the next load the
+ * full conversion again. */
+static void
+glb_model_store_cache(
+    const glb_model *model,
+    const u8        *vertices,
+    const u8        *indices) {
+    const gltf_json_data *gltf_json= &model->gltf_json;
+    glb_cache_header      header   = {0};
+    if(!glb_hash_file(
+           model->file_handle,
+           &header.source_hash,
+           &header.source_size))
+        return;
+    header.magic            = GLB_CACHE_MAGIC;
+    header.version          = GLB_CACHE_VERSION;
+    header.vertex_format    = load_options.vertex_format;
+    header.vertex_size      = glb_vertex_size();
+    header.index_size       = glb_min_index_size();
+    header.vertex_cache_size= glb_vertex_cache_size();
+    header.welded           = load_options.weld_vertices;
+    header.lods             = load_options.generate_lods;
+    header.json_sections    = gltf_json->loaded_sections;
+    header.buffer           = gltf_json->buffer;
+    const void *section_list[glb_cache_section_count]= {
+        gltf_json->accessor_list,
+        gltf_json->buffer_view_list,
+        gltf_json->mesh_list,
+        gltf_json->primitive_list,
+        gltf_json->node_list,
+        model->primitive_list,
+        vertices,
+        indices};
+    header.section_size[glb_cache_section_accessors]=
+        sizeof(gltf_accessor) * gltf_json->accessor_count;
+    header.section_size[glb_cache_section_buffer_views]=
+        sizeof(gltf_buffer_view) * gltf_json->buffer_view_count;
+    header.section_size[glb_cache_section_meshes]=
+        sizeof(gltf_mesh) * gltf_json->mesh_count;
+    header.section_size[glb_cache_section_gltf_primitives]=
+        sizeof(gltf_mesh_primitive) * gltf_json->primitive_count;
+    header.section_size[glb_cache_section_nodes]=
+        sizeof(gltf_node) * gltf_json->node_count;
+    header.section_size[glb_cache_section_primitives]=
+        sizeof(mesh_primitive_t) * model->primitive_count;
+    header.section_size[glb_cache_section_vertices]=
+        (u64)header.vertex_size * model->vertex_count;
+    header.section_size[glb_cache_section_indices]= model->index_size;
+    glb_cache_write(model->cache_path, &header, section_list);
+}
+
+/* Sets the dequantization of a primitive from its POSITION bounds. glTF
+ * requires min and max on POSITION accessors, files without them get their
+ * positions scanned once. */
+static bool
+glb_model_position_transform(
+    glb_model                  *model,
+    const gltf_accessor        *pos_accessor,
+    const glb_primitive_source *source,
+    mesh_primitive_t           *primitive) {
+    primitive->pos_offset= vec3_make(0.F, 0.F, 0.F);
+    primitive->pos_scale = vec3_make(1.F, 1.F, 1.F);
+    if(load_options.vertex_format == vertex_format_float) return true;
+    vec3 min= vec3_make(0.F, 0.F, 0.F);
+    vec3 max= vec3_make(0.F, 0.F, 0.F);
+    if(pos_accessor->bounds_count >= 3) {
+        // Bounds are stored before normalization
+        accessor_layout layout;
+        glb_accessor_layout(&model->gltf_json, pos_accessor, &layout);
+        for(u32 c= 0; c < 3; ++c) {
+            min.data[c]=
+                accessor_normalize_bound(&layout, pos_accessor->min[c]);
+            max.data[c]=
+                accessor_normalize_bound(&layout, pos_accessor->max[c]);
+        }
+    } else if(pos_accessor->count) {
+        const accessor_decoder *decoder= &source->pos;
+        u8                     *window = null;
+        if(!model->mapped_file.view) {
+            window= HeapAlloc(
+                process_heap,
+                0,
+                (u64)decoder->stride * GLB_DIRECT_READ_WINDOW);
+            if(!window) return false;
+        }
+        for(u32 first= 0; first < pos_accessor->count;
+            first+= GLB_DIRECT_READ_WINDOW) {
+            u32 count= pos_accessor->count - first;
+            if(count > GLB_DIRECT_READ_WINDOW) count= GLB_DIRECT_READ_WINDOW;
+            u64 raw_offset= source->pos_offset + (u64)decoder->stride * first;
+            const u8 *raw_data= model->mapped_file.bin_data + raw_offset;
+            if(window) {
+                if(!win32_read(
+                       model->file_handle,
+                       window,
+                       accessor_source_size(decoder, count),
+                       model->bin_data_offset + raw_offset)) {
+                    HeapFree(process_heap, 0, window);
+                    return false;
+                }
+                raw_data= window;
+            }
+            for(u32 block= 0; block < count; block+= GLB_DECODE_BLOCK) {
+                u32 block_count= count - block;
+                if(block_count > GLB_DECODE_BLOCK)
+                    block_count= GLB_DECODE_BLOCK;
+                vec3 pos_data[GLB_DECODE_BLOCK];
+                accessor_decode(
+                    decoder,
+                    raw_data + (u64)decoder->stride * block,
+                    block_count,
+                    pos_data);
+                if(!first && !block) min= max= pos_data[0];
+                for(u32 i= 0; i < block_count; ++i) {
+                    for(u32 c= 0; c < 3; ++c) {
+                        f32 value= pos_data[i].data[c];
+                        if(value < min.data[c]) min.data[c]= value;
+                        if(value > max.data[c]) max.data[c]= value;
+                    }
+                }
+            }
+        }
+        if(window) HeapFree(process_heap, 0, window);
+    }
+    for(u32 c= 0; c < 3; ++c) {
+        primitive->pos_offset.data[c]= (min.data[c] + max.data[c]) * .5F;
+        primitive->pos_scale.data[c] = (max.data[c] - min.data[c]) * .5F;
+        // A flat axis quantizes every position to 0
+        if(!(primitive->pos_scale.data[c] > 0.F))
+            primitive->pos_scale.data[c]= 1.F;
+    }
+    return true;
+}
+
+/* Index width of a primitive with `vertex_count` vertices. Indices are
+ * relative to the first vertex of the primitive, so the narrowest width
+ * holding vertex_count - 1 is enough, and a source narrower than that
+ * already holds every index it has. Non-indexed primitives pass a null
+ * accessor. */
+static accessor_target
+glb_index_target(const gltf_accessor *idx_accessor, u32 vertex_count) {
+    u32 component_type= idx_accessor ? idx_accessor->component_type : 0;
+    u32 index_size    = 4;
+    if(component_type == gltf_accessor_component_ubyte ||
+       vertex_count <= 0x100u)
+        index_size= 1;
+    else if(component_type == gltf_accessor_component_ushort ||
+            vertex_count <= 0x10000u)
+        index_size= 2;
+    if(index_size < glb_min_index_size()) index_size= glb_min_index_size();
+    if(index_size == 1) return accessor_target_u8;
+    return index_size == 2 ? accessor_target_u16 : accessor_target_u32;
+}
+
+/* Decoders of the attributes and indices of a primitive, fails for layouts
+ * that can't be decoded and for elements reaching past the BIN chunk. */
+static bool
+glb_primitive_source_make(
+    const glb_model           *model,
+    const gltf_mesh_primitive *gltf_primitive,
+    glb_primitive_source      *out) {
+    const gltf_json_data *gltf_json= &model->gltf_json;
+    if(!glb_accessor_decoder(
+           gltf_json,
+           gltf_primitive->pos_accessor,
+           accessor_target_vec3,
+           &out->pos,
+           &out->pos_offset))
+        return false;
+    out->generate_normals= gltf_primitive->nrm_accessor == GLTF_NO_ACCESSOR;
+    if(out->generate_normals) {
+        out->nrm       = out->pos;
+        out->nrm_offset= out->pos_offset;
+    } else if(!glb_accessor_decoder(
+                  gltf_json,
+                  gltf_primitive->nrm_accessor,
+                  accessor_target_vec3,
+                  &out->nrm,
+                  &out->nrm_offset)) {
+        return false;
+    }
+    const gltf_accessor *accessor_list= gltf_json->accessor_list;
+    u32 vertex_count= accessor_list[gltf_primitive->pos_accessor].count;
+    u32 index_count = vertex_count;
+    out->sequential_indices= gltf_primitive->idx_accessor == GLTF_NO_ACCESSOR;
+    if(out->sequential_indices) {
+        // Nothing is read, the width is all the conversion needs
+        accessor_target target= glb_index_target(null, vertex_count);
+        out->idx              = (accessor_decoder){0};
+        out->idx.target_size  = target == accessor_target_u8  ? 1 :
+                                target == accessor_target_u16 ? 2 :
+                                                                4;
+        out->idx_offset       = 0;
+    } else {
+        if(gltf_primitive->idx_accessor >= gltf_json->accessor_count)
+            return false;
+        const gltf_accessor *idx_accessor=
+            &accessor_list[gltf_primitive->idx_accessor];
+        index_count= idx_accessor->count;
+        if(!glb_accessor_decoder(
+               gltf_json,
+               gltf_primitive->idx_accessor,
+               glb_index_target(idx_accessor, vertex_count),
+               &out->idx,
+               &out->idx_offset))
+            return false;
+    }
+    return (out->generate_normals ||
+            accessor_list[gltf_primitive->nrm_accessor].count >=
+                vertex_count) &&
+           out->pos_offset + accessor_source_size(&out->pos, vertex_count) <=
+               model->bin_length &&
+           out->nrm_offset + accessor_source_size(&out->nrm, vertex_count) <=
+               model->bin_length &&
+           out->idx_offset + accessor_source_size(&out->idx, index_count) <=
+               model->bin_length;
+}
+
+/* Reads the chunk headers, starts the BIN chunk read when loading through a
+ * heap buffer and parses the JSON chunk. */
+static bool
+glb_model_open(glb_model *model) {
+    model->file_handle= CreateFile(
+        model->file_path,
+        FILE_READ_ATTRIBUTES | FILE_READ_DATA,
+        FILE_SHARE_READ,
+        NULL,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED,
+        NULL);
+    if(model->file_handle == INVALID_HANDLE_VALUE) {
+        model->file_handle= NULL;
+        return false;
+    }
+    /*------------------------------------------------------------------------*/
+    /* Skip Parsing and Conversion when the Cache Matches the File            */
+    /*------------------------------------------------------------------------*/
+    if(load_options.use_cache) {
+        u64 path_length= 0;
+        while(model->file_path[path_length]) ++path_length;
+        static const WCHAR cache_extension[]= L".cache";
+        model->cache_path                   = HeapAlloc(
+            process_heap,
+            0,
+            sizeof(WCHAR) * path_length + sizeof(cache_extension));
+        if(!model->cache_path) return false;
+        __movsb(
+            (u8 *)model->cache_path,
+            (const u8 *)model->file_path,
+            sizeof(WCHAR) * path_length);
+        __movsb(
+            (u8 *)(model->cache_path + path_length),
+            (const u8 *)cache_extension,
+            sizeof(cache_extension));
+        if(glb_cache_open(
+               model->cache_path,
+               model->file_handle,
+               load_options.json_sections,
+               &model->cache)) {
+            glb_model_load_cache(model);
+            return true;
+        }
+    }
+    gltf_json_data *gltf_json= &model->gltf_json;
+    model->allocator         = g_allocator;
+    if(load_options.use_arena) {
+        gltf_arena *arena = &gltf_json_arenas[job_thread_index()];
+        arena->zero_memory= true;
+        model->allocator  = gltf_arena_allocator(arena);
+    }
+    if(load_options.load_mode == glb_load_mode_mapped) {
+        if(!glb_map_file(model->file_handle, &model->mapped_file))
+            return false;
+        model->bin_length= model->mapped_file.bin_length;
+        gltf_parse_json(
+            gltf_json,
+            model->mapped_file.json_data,
+            model->mapped_file.json_length,
+            &gltf_token_arenas[job_thread_index()],
+            load_options.json_sections,
+            &model->allocator);
+        gltf_release_json_index(gltf_json);
+    } else {
+        LARGE_INTEGER file_size= {0};
+        glb_header    header   = {0};
+        if(!GetFileSizeEx(model->file_handle, &file_size) ||
+           !win32_read(model->file_handle, &header, sizeof(glb_header), 0) ||
+           header.magic != 0x46546C67u)
+            return false;
+        DWORD            json_chunk_offset= sizeof(glb_header);
+        glb_chunk_header json_chunk       = {0};
+        if(!win32_read(
+               model->file_handle,
+               &json_chunk,
+               sizeof(glb_chunk_header),
+               json_chunk_offset) ||
+           json_chunk.type != glb_chunk_json)
+            return false;
+        u64 bin_chunk_offset=
+            json_chunk_offset + sizeof(glb_chunk_header) + json_chunk.length;
+        glb_chunk_header bin_chunk= {0};
+        if(!win32_read(
+               model->file_handle,
+               &bin_chunk,
+               sizeof(glb_chunk_header),
+               bin_chunk_offset) ||
+           bin_chunk.type != glb_chunk_bin)
+            return false;
+        model->bin_data_offset= bin_chunk_offset + sizeof(glb_chunk_header);
+        model->bin_length     = glb_chunk_length(
+            bin_chunk.length,
+            model->bin_data_offset,
+            file_size.QuadPart);
+        if(model->bin_data_offset + model->bin_length >
+           (u64)file_size.QuadPart)
+            return false;
+        /*--------------------------------------------------------------------*/
+        /* Kick off the BIN chunk read, it completes in the background while  */
+        /* the JSON chunk is parsed and Vulkan is initialized                 */
+        /*--------------------------------------------------------------------*/
+        if(load_options.load_mode == glb_load_mode_read) {
+            model->bin_chunk_buffer=
+                HeapAlloc(process_heap, 0, model->bin_length);
+            if(!model->bin_chunk_buffer ||
+               !win32_begin_read(
+                   model->file_handle,
+                   model->bin_chunk_buffer,
+                   model->bin_length,
+                   model->bin_data_offset,
+                   &model->bin_chunk_read))
+                return false;
+        }
+        void *json_chunk_data= HeapAlloc(process_heap, 0, json_chunk.length);
+        if(!json_chunk_data) return false;
+        if(!win32_read(
+               model->file_handle,
+               json_chunk_data,
+               json_chunk.length,
+               json_chunk_offset + sizeof(glb_chunk_header))) {
+            HeapFree(process_heap, 0, json_chunk_data);
+            return false;
+        }
+        gltf_parse_json(
+            gltf_json,
+            json_chunk_data,
+            json_chunk.length,
+            &gltf_token_arenas[job_thread_index()],
+            load_options.json_sections,
+            &model->allocator);
+        gltf_release_json_index(gltf_json);
+        HeapFree(process_heap, 0, json_chunk_data);
+    }
+    model->primitive_count= gltf_json->primitive_count;
+    // Written to the cache whole, padding included
+    model->primitive_list= HeapAlloc(
+        process_heap,
+        HEAP_ZERO_MEMORY,
+        sizeof(mesh_primitive_t) * model->primitive_count);
+    model->source_list= HeapAlloc(
+        process_heap,
+        0,
+        sizeof(glb_primitive_source) * model->primitive_count);
+    if(model->primitive_count &&
+       (!model->primitive_list || !model->source_list))
+        return false;
+    model->packed_vertices= true;
+    for(u32 i= 0; i < model->primitive_count; ++i) {
+        gltf_mesh_primitive *gltf_primitive= &gltf_json->primitive_list[i];
+        mesh_primitive_t    *primitive     = &model->primitive_list[i];
+        if(!glb_primitive_source_make(
+               model,
+               gltf_primitive,
+               &model->source_list[i]))
+            return false;
+        glb_primitive_source *source= &model->source_list[i];
+        model->packed_vertices= model->packed_vertices &&
+                                source->pos.passthrough &&
+                                source->nrm.passthrough;
+        gltf_accessor *pos_accessor=
+            &gltf_json->accessor_list[gltf_primitive->pos_accessor];
+        if(!glb_model_position_transform(
+               model,
+               pos_accessor,
+               source,
+               primitive))
+            return false;
+        primitive->vertex_count = pos_accessor->count;
+        primitive->vertex_offset= (u32)model->vertex_count;
+        primitive->first_cluster= 0;
+        primitive->cluster_count= 0;
+        primitive->lod_count    = 0;
+        primitive->bounds       = (vec4){0};
+        __stosb((u8 *)primitive->lod_list, 0, sizeof(primitive->lod_list));
+        primitive->index_count=
+            source->sequential_indices ?
+                primitive->vertex_count :
+                gltf_json->accessor_list[gltf_primitive->idx_accessor].count;
+        primitive->index_size= source->idx.target_size;
+        u32 index_capacity   =
+            glb_index_capacity(gltf_primitive, primitive->index_count);
+        // Ranges start aligned to their own width, so index_offset counts
+        // whole elements
+        u64 index_start= (model->index_size + primitive->index_size - 1) &
+                         ~(u64)(primitive->index_size - 1);
+        primitive->index_offset= (u32)(index_start / primitive->index_size);
+        model->vertex_count+= primitive->vertex_count;
+        model->index_size=
+            index_start + (u64)primitive->index_size * index_capacity;
+    }
+    // Keeps the ranges of the models after this one aligned for every width
+    model->index_size= (model->index_size + 3) & ~3ull;
+    return true;
+}
+
+/* Elements per conversion job, a range of float vertices or 16-bit indices
+ * is 2 MB of staging writes and primitives larger than that are split over
+ * several jobs. */
+#define GLB_CONVERT_VERTEX_RANGE (1u << 16)
+#define GLB_CONVERT_INDEX_RANGE  (1u << 20)
+
+/* Writes the indices `first` to `first + count - 1` of a non-indexed
+ * primitive in the index width. */
+static void
+glb_sequential_indices(u32 index_size, u32 first, u32 count, u8 *out) {
+    for(u32 i= 0; i < count; ++i) {
+        if(index_size == 1) out[i]= (u8)(first + i);
+        else if(index_size == 2) ((u16 *)out)[i]= (u16)(first + i);
+        else ((u32 *)out)[i]= first + i;
+    }
+}
+
+/* One slice of a primitive, an index range has no second source. */
+typedef struct glb_convert_range {
+    const mesh_primitive_t     *primitive;
+    const glb_primitive_source *source;
+    const u8                   *source_data[2];
+    u8                         *dest;
+    u32                         first;
+    u32                         count;
+} glb_convert_range;
+
+static void
+glb_convert_range_job(void *user_data, u32 index) {
+    glb_convert_range *range= &((glb_convert_range *)user_data)[index];
+    if(range->source_data[1]) {
+        glb_decode_vertices(
+            range->primitive,
+            range->source,
+            range->source_data[0],
+            range->source_data[1],
+            range->count,
+            range->dest);
+    } else if(range->source->sequential_indices) {
+        glb_sequential_indices(
+            range->source->idx.target_size,
+            range->first,
+            range->count,
+            range->dest);
+    } else {
+        accessor_decode(
+            &range->source->idx,
+            range->source_data[0],
+            range->count,
+            range->dest);
+    }
+}
+
+/* Zeroes the bytes between index ranges of different widths, so the
+ * staging contents and the cache written from them are deterministic. */
+static void
+glb_clear_index_padding(const glb_model *model, u8 *indices) {
+    u64 end= 0;
+    for(u32 i= 0; i < model->primitive_count; ++i) {
+        const mesh_primitive_t *primitive= &model->primitive_list[i];
+        u64 start= (u64)primitive->index_size * primitive->index_offset;
+        if(start > end) __stosb(indices + end, 0, start - end);
+        end= start + (u64)primitive->index_size * primitive->index_count;
+    }
+    if(model->index_size > end)
+        __stosb(indices + end, 0, model->index_size - end);
+}
+
+/* Fills the model's range of the mapped staging memory, `vertices` and
+ * `indices` point at its first vertex and first index byte. */
+static bool
+glb_model_convert(glb_model *model, u8 *vertices, u8 *indices) {
+    u32 vertex_size= glb_vertex_size();
+    if(model->cache.view) {
+        const glb_cache_header *header= model->cache.header;
+        __movsb(
+            vertices,
+            model->cache.view +
+                header->section_offset[glb_cache_section_vertices],
+            header->section_size[glb_cache_section_vertices]);
+        __movsb(
+            indices,
+            model->cache.view +
+                header->section_offset[glb_cache_section_indices],
+            header->section_size[glb_cache_section_indices]);
+        return true;
+    }
+    if(model->welded_data) {
+        u64 vertices_size= (u64)vertex_size * model->vertex_count;
+        __movsb(vertices, model->welded_data, vertices_size);
+        __movsb(indices, model->welded_data + vertices_size, model->index_size);
+        return true;
+    }
+    glb_clear_index_padding(model, indices);
+    if(load_options.load_mode == glb_load_mode_stream ||
+       load_options.load_mode == glb_load_mode_direct) {
+        /*--------------------------------------------------------------------*/
+        /* Stream Binary Chunk Data through Bounded Windows                   */
+        /*--------------------------------------------------------------------*/
+        // Quantized vertices are smaller than their raw attributes and can't
+        // be converted in place, neither can attributes or indices that need
+        // decoding, only the rest is read straight into the staging buffer
+        bool direct_vertices=
+            load_options.load_mode == glb_load_mode_direct &&
+            load_options.vertex_format == vertex_format_float &&
+            model->packed_vertices;
+        glb_stream stream;
+        if(!glb_stream_open(model->file_handle, &stream)) return false;
+        bool res= true;
+        for(u32 i= 0; res && i < model->primitive_count; ++i) {
+            const mesh_primitive_t     *primitive= &model->primitive_list[i];
+            const glb_primitive_source *source   = &model->source_list[i];
+            u8 *primitive_indices=
+                indices + (u64)primitive->index_size * primitive->index_offset;
+            if(direct_vertices) {
+                res= glb_read_vertices_direct(
+                    model->file_handle,
+                    model->bin_data_offset + source->pos_offset,
+                    model->bin_data_offset + source->nrm_offset,
+                    primitive->vertex_count,
+                    (vertex *)vertices);
+            } else {
+                glb_stream_source vertex_sources[2]= {
+                    {model->bin_data_offset + source->pos_offset, &source->pos},
+                    {model->bin_data_offset + source->nrm_offset,
+                     &source->nrm}};
+                glb_stream_vertex_target vertex_target= {
+                    .primitive= primitive,
+                    .source   = source,
+                    .vertices = vertices};
+                res= glb_stream_elements(
+                    &stream,
+                    vertex_sources,
+                    2,
+                    primitive->vertex_count,
+                    glb_stream_convert_vertices,
+                    &vertex_target);
+            }
+            if(!res) break;
+            if(source->sequential_indices) {
+                glb_sequential_indices(
+                    primitive->index_size,
+                    0,
+                    primitive->index_count,
+                    primitive_indices);
+            } else if(load_options.load_mode == glb_load_mode_direct &&
+                      source->idx.passthrough) {
+                // Indices already in their final width are read into place
+                // without any conversion
+                res= win32_read(
+                    model->file_handle,
+                    primitive_indices,
+                    (u64)primitive->index_size * primitive->index_count,
+                    model->bin_data_offset + source->idx_offset);
+            } else {
+                glb_stream_source index_source= {
+                    model->bin_data_offset + source->idx_offset,
+                    &source->idx};
+                glb_stream_index_target index_target= {
+                    .decoder= &source->idx,
+                    .indices= primitive_indices};
+                res= glb_stream_elements(
+                    &stream,
+                    &index_source,
+                    1,
+                    primitive->index_count,
+                    glb_stream_decode_indices,
+                    &index_target);
+            }
+            vertices+= (u64)vertex_size * primitive->vertex_count;
+        }
+        glb_stream_close(&stream);
+        return res;
+    }
+    const u8 *bin_chunk_data= model->mapped_file.bin_data;
+    if(load_options.load_mode == glb_load_mode_read) {
+        if(!win32_wait_read(model->file_handle, &model->bin_chunk_read))
+            return false;
+        bin_chunk_data= model->bin_chunk_buffer;
+    }
+    /*------------------------------------------------------------------------*/
+    /* Decode Data from Binary Chunk into Staging Buffer                      */
+    /*------------------------------------------------------------------------*/
+    u32 range_count= 0;
+    for(u32 i= 0; i < model->primitive_count; ++i) {
+        const mesh_primitive_t *primitive= &model->primitive_list[i];
+        range_count+= (primitive->vertex_count + GLB_CONVERT_VERTEX_RANGE - 1) /
+                      GLB_CONVERT_VERTEX_RANGE;
+        range_count+= (primitive->index_count + GLB_CONVERT_INDEX_RANGE - 1) /
+                      GLB_CONVERT_INDEX_RANGE;
+    }
+    glb_convert_range *range_list=
+        HeapAlloc(process_heap, 0, sizeof(glb_convert_range) * range_count);
+    if(range_count && !range_list) return false;
+    glb_convert_range *range= range_list;
+    for(u32 i= 0; i < model->primitive_count; ++i) {
+        const mesh_primitive_t     *primitive= &model->primitive_list[i];
+        const glb_primitive_source *source   = &model->source_list[i];
+        /*--------------------------------------------------------------------*/
+        /* POSITION and NORMAL Attributes                                     */
+        /*--------------------------------------------------------------------*/
+        const u8 *pos_data= bin_chunk_data + source->pos_offset;
+        const u8 *nrm_data= bin_chunk_data + source->nrm_offset;
+        for(u32 first= 0; first < primitive->vertex_count;
+            first+= GLB_CONVERT_VERTEX_RANGE) {
+            range->primitive     = primitive;
+            range->source        = source;
+            range->source_data[0]= pos_data + (u64)source->pos.stride * first;
+            range->source_data[1]= nrm_data + (u64)source->nrm.stride * first;
+            range->dest          = vertices + (u64)vertex_size * first;
+            range->first         = first;
+            range->count         = primitive->vertex_count - first;
+            if(range->count > GLB_CONVERT_VERTEX_RANGE)
+                range->count= GLB_CONVERT_VERTEX_RANGE;
+            ++range;
+        }
+        vertices+= (u64)vertex_size * primitive->vertex_count;
+        /*--------------------------------------------------------------------*/
+        /* INDEX                                                              */
+        /*--------------------------------------------------------------------*/
+        const u8 *idx_data  = bin_chunk_data + source->idx_offset;
+        u32       index_size= primitive->index_size;
+        u8       *idx_dest  =
+            indices + (u64)index_size * primitive->index_offset;
+        for(u32 first= 0; first < primitive->index_count;
+            first+= GLB_CONVERT_INDEX_RANGE) {
+            range->primitive     = primitive;
+            range->source        = source;
+            range->source_data[0]= idx_data + (u64)source->idx.stride * first;
+            range->source_data[1]= null;
+            range->dest          = idx_dest + (u64)index_size * first;
+            range->first         = first;
+            range->count         = primitive->index_count - first;
+            if(range->count > GLB_CONVERT_INDEX_RANGE)
+                range->count= GLB_CONVERT_INDEX_RANGE;
+            ++range;
+        }
+    }
+    if(range_count > 1 && job_system_thread_count() > 1) {
+        job_dispatch(glb_convert_range_job, range_list, range_count);
+    } else {
+        for(u32 i= 0; i < range_count; ++i)
+            glb_convert_range_job(range_list, i);
+    }
+    if(range_list) HeapFree(process_heap, 0, range_list);
+    return true;
+}
+
+/*============================================================================*/
+/* Vertex Cache Optimization                                                  */
+/*============================================================================*/
+static void
+glb_indices_widen(const u8 *indices, u32 index_size, u32 count, u32 *out) {
+    for(u32 i= 0; i < count; ++i) {
+        if(index_size == 1) out[i]= indices[i];
+        else if(index_size == 2) out[i]= ((const u16 *)indices)[i];
+        else out[i]= ((const u32 *)indices)[i];
+    }
+}
+
+static void
+glb_indices_narrow(const u32 *indices, u32 index_size, u32 count, u8 *out) {
+    for(u32 i= 0; i < count; ++i) {
+        if(index_size == 1) out[i]= (u8)indices[i];
+        else if(index_size == 2) ((u16 *)out)[i]= (u16)indices[i];
+        else ((u32 *)out)[i]= indices[i];
+    }
+}
+
+/* Reorders the triangles of every triangle list primitive for the vertex
+ * cache and its vertices for fetch, in the converted staging range. Index
+ * widths stay the same, the reordering only permutes vertices. Primitives
+ * with out-of-range indices or other topologies are left as they are. */
+static bool
+glb_model_optimize(glb_model *model, u8 *vertices, u8 *indices) {
+    u32 vertex_size= glb_vertex_size();
+    u64 block_size = 0;
+    for(u32 i= 0; i < model->primitive_count; ++i) {
+        const mesh_primitive_t *primitive= &model->primitive_list[i];
+        u64 size= sizeof(u32) * (u64)primitive->index_count +
+                  (sizeof(u32) + vertex_size) * (u64)primitive->vertex_count +
+                  mesh_optimize_scratch_size(
+                      primitive->index_count,
+                      primitive->vertex_count);
+        if(size > block_size) block_size= size;
+    }
+    if(!block_size) return true;
+    u8 *block= HeapAlloc(process_heap, 0, block_size);
+    if(!block) return false;
+    for(u32 i= 0; i < model->primitive_count; ++i) {
+        const mesh_primitive_t *primitive= &model->primitive_list[i];
+        u32 index_count = primitive->index_count;
+        u32 vertex_count= primitive->vertex_count;
+        if(model->gltf_json.primitive_list[i].mode != 4 || !index_count)
+            continue;
+        u32 *wide_indices= (u32 *)block;
+        u32 *remap       = wide_indices + index_count;
+        u8  *vertex_copy = (u8 *)(remap + vertex_count);
+        u8  *scratch     = vertex_copy + (u64)vertex_size * vertex_count;
+        u8  *primitive_indices=
+            indices + (u64)primitive->index_size * primitive->index_offset;
+        u8 *primitive_vertices=
+            vertices + (u64)vertex_size * primitive->vertex_offset;
+        glb_indices_widen(
+            primitive_indices,
+            primitive->index_size,
+            index_count,
+            wide_indices);
+        if(!mesh_triangles_valid(wide_indices, index_count, vertex_count))
+            continue;
+        mesh_analyze_vertex_cache(
+            wide_indices,
+            index_count,
+            vertex_count,
+            scratch,
+            &model->cache_stats[0]);
+        mesh_optimize_vertex_cache(
+            wide_indices,
+            index_count,
+            vertex_count,
+            scratch);
+        mesh_analyze_vertex_cache(
+            wide_indices,
+            index_count,
+            vertex_count,
+            scratch,
+            &model->cache_stats[1]);
+        mesh_optimize_vertex_fetch(
+            wide_indices,
+            index_count,
+            vertex_count,
+            remap);
+        __movsb(
+            vertex_copy,
+            primitive_vertices,
+            (u64)vertex_size * vertex_count);
+        for(u32 v= 0; v < vertex_count; ++v) {
+            __movsb(
+                primitive_vertices + (u64)vertex_size * remap[v],
+                vertex_copy + (u64)vertex_size * v,
+                vertex_size);
+        }
+        glb_indices_narrow(
+            wide_indices,
+            primitive->index_size,
+            index_count,
+            primitive_indices);
+    }
+    HeapFree(process_heap, 0, block);
+    return true;
+}
+
+/*============================================================================*/
+/* Normal Generation                                                          */
+/*============================================================================*/
+/* Positions as the vertex shader reads them, before the dequantization the
+ * world matrix applies. */
+static void
+glb_decode_positions(const u8 *vertices, u32 count, vec3 *out) {
+    for(u32 i= 0; i < count; ++i) {
+        if(load_options.vertex_format == vertex_format_float) {
+            const vertex *v= &((const vertex *)vertices)[i];
+            out[i]         = vec3_make(v->pos.x, v->pos.y, v->pos.z);
+            continue;
+        }
+        const s16 *pos= load_options.vertex_format == vertex_format_oct16 ?
+                            ((const vertex_oct16 *)vertices)[i].pos :
+                            ((const vertex_oct8 *)vertices)[i].pos;
+        // snorm16 attributes clamp -32768 to -1
+        for(u32 c= 0; c < 3; ++c) {
+            f32 value     = pos[c] * (1.F / 32767.F);
+            out[i].data[c]= value < -1.F ? -1.F : value;
+        }
+    }
+}
+
+/* Triangles per chunk of normal sums and vertices per job of the passes over
+ * vertices. The chunking doesn't depend on the thread count, so neither do
+ * the sums or the cache written from them. */
+#define GLB_NORMAL_CHUNK_TRIANGLES (1u << 16)
+#define GLB_NORMAL_VERTEX_RANGE    (1u << 16)
+// Chunks of a primitive whose spans add up to more sums than this many per
+// vertex, like those of a mesh in random order, are merged into at most
+// GLB_NORMAL_MERGED_CHUNKS, which bounds the sums at that many per vertex
+#define GLB_NORMAL_MAX_SPAN_RATIO 4u
+#define GLB_NORMAL_MERGED_CHUNKS  8u
+
+typedef struct glb_normal_primitive {
+    u32  *indices;
+    vec3 *positions;
+    u32   index_count; // 0 for topologies other than triangle lists
+    u32   vertex_count;
+    // Narrow indices the chunks widen into `indices` first, or null
+    const u8 *source_indices;
+    u32       source_index_size;
+    // May be `positions`, no sum reads them after the first normal is
+    // written
+    vec3 *normals;
+    // Converted vertices the positions are decoded from and the normals go
+    // into, with the dequantization scale of their positions, or null
+    u8                *vertices;
+    vec3               pos_scale;
+    mesh_normal_chunk *chunks;
+    u32                chunk_count;
+} glb_normal_primitive;
+
+/* A chunk or a range of vertices of a primitive. */
+typedef struct glb_normal_job {
+    glb_normal_primitive *primitive;
+    u32                   first;
+    u32                   count;
+} glb_normal_job;
+
+static void
+glb_normal_span_job(void *user_data, u32 index) {
+    glb_normal_job       *job      = &((glb_normal_job *)user_data)[index];
+    glb_normal_primitive *primitive= job->primitive;
+    mesh_normal_chunk    *chunk    = &primitive->chunks[job->first];
+    if(primitive->source_indices) {
+        u32 first_index= (u32)(chunk->indices - primitive->indices);
+        glb_indices_widen(
+            primitive->source_indices +
+                (u64)primitive->source_index_size * first_index,
+            primitive->source_index_size,
+            chunk->index_count,
+            primitive->indices + first_index);
+    }
+    mesh_normal_chunk_span(chunk, primitive->vertex_count);
+}
+
+static void
+glb_normal_sum_job(void *user_data, u32 index) {
+    glb_normal_job       *job      = &((glb_normal_job *)user_data)[index];
+    glb_normal_primitive *primitive= job->primitive;
+    mesh_normal_chunk_sum(
+        &primitive->chunks[job->first],
+        primitive->positions,
+        primitive->vertex_count);
+}
+
+static void
+glb_normal_resolve_job(void *user_data, u32 index) {
+    glb_normal_job       *job      = &((glb_normal_job *)user_data)[index];
+    glb_normal_primitive *primitive= job->primitive;
+    vec3                 *normals  = primitive->normals + job->first;
+    mesh_normals_resolve(
+        primitive->chunks,
+        primitive->chunk_count,
+        job->first,
+        job->count,
+        normals);
+    if(primitive->vertices) {
+        vertex_write_normals(
+            load_options.vertex_format,
+            normals,
+            job->count,
+            primitive->vertices + (u64)glb_vertex_size() * job->first);
+    }
+}
+
+/* Merges the chunks of a primitive whose spans overlap too much, see
+ * GLB_NORMAL_MAX_SPAN_RATIO, and returns the sums its chunks need. */
+static u64
+glb_normal_merge_chunks(glb_normal_primitive *primitive) {
+    u64 sum_count= 0;
+    for(u32 c= 0; c < primitive->chunk_count; ++c)
+        sum_count+= primitive->chunks[c].vertex_count;
+    if(sum_count <= (u64)GLB_NORMAL_MAX_SPAN_RATIO * primitive->vertex_count ||
+       primitive->chunk_count <= GLB_NORMAL_MERGED_CHUNKS)
+        return sum_count;
+    u32 chunk_count= primitive->chunk_count;
+    sum_count      = 0;
+    for(u32 group= 0; group < GLB_NORMAL_MERGED_CHUNKS; ++group) {
+        u32 first= (u32)((u64)chunk_count * group / GLB_NORMAL_MERGED_CHUNKS);
+        u32 end  =
+            (u32)((u64)chunk_count * (group + 1) / GLB_NORMAL_MERGED_CHUNKS);
+        // Chunks are consecutive index ranges, so a group is one as well
+        mesh_normal_chunk merged    = primitive->chunks[first];
+        u32               span_first= ~0u;
+        u32               span_end  = 0;
+        merged.index_count          = 0;
+        for(u32 c= first; c < end; ++c) {
+            const mesh_normal_chunk *chunk= &primitive->chunks[c];
+            merged.index_count+= chunk->index_count;
+            if(!chunk->vertex_count) continue;
+            u32 chunk_end= chunk->first_vertex + chunk->vertex_count;
+            if(chunk->first_vertex < span_first)
+                span_first= chunk->first_vertex;
+            if(chunk_end > span_end) span_end= chunk_end;
+        }
+        merged.first_vertex     = span_end ? span_first : 0;
+        merged.vertex_count     = span_end - merged.first_vertex;
+        primitive->chunks[group]= merged;
+        sum_count+= merged.vertex_count;
+    }
+    primitive->chunk_count= GLB_NORMAL_MERGED_CHUNKS;
+    return sum_count;
+}
+
+/* Runs the three passes over the chunks and vertices of every primitive of
+ * the list, each pass one dispatch: spans, sums, normals. */
+static bool
+glb_generate_normals(glb_normal_primitive *primitive_list, u32 count) {
+    u64 chunk_count= 0, vertex_job_count= 0;
+    for(u32 i= 0; i < count; ++i) {
+        chunk_count+= (primitive_list[i].index_count / 3 +
+                       GLB_NORMAL_CHUNK_TRIANGLES - 1) /
+                      GLB_NORMAL_CHUNK_TRIANGLES;
+        vertex_job_count+= (primitive_list[i].vertex_count +
+                            GLB_NORMAL_VERTEX_RANGE - 1) /
+                           GLB_NORMAL_VERTEX_RANGE;
+    }
+    u64 job_count=
+        chunk_count > vertex_job_count ? chunk_count : vertex_job_count;
+    u8 *block= HeapAlloc(
+        process_heap,
+        0,
+        sizeof(mesh_normal_chunk) * chunk_count +
+            sizeof(glb_normal_job) * job_count);
+    if(!block) return false;
+    mesh_normal_chunk *chunk   = (mesh_normal_chunk *)block;
+    glb_normal_job    *job_list= (glb_normal_job *)(chunk + chunk_count);
+    glb_normal_job    *job     = job_list;
+    for(u32 i= 0; i < count; ++i) {
+        glb_normal_primitive *primitive  = &primitive_list[i];
+        u32                   index_count= primitive->index_count / 3 * 3;
+        primitive->chunks     = chunk;
+        primitive->chunk_count= 0;
+        for(u32 first= 0; first < index_count;
+            first+= 3 * GLB_NORMAL_CHUNK_TRIANGLES) {
+            chunk->indices    = primitive->indices + first;
+            chunk->index_count= index_count - first;
+            if(chunk->index_count > 3 * GLB_NORMAL_CHUNK_TRIANGLES)
+                chunk->index_count= 3 * GLB_NORMAL_CHUNK_TRIANGLES;
+            *job++= (glb_normal_job){primitive, primitive->chunk_count++, 1};
+            ++chunk;
+        }
+    }
+    job_dispatch(glb_normal_span_job, job_list, (u32)(job - job_list));
+    /*------------------------------------------------------------------------*/
+    /* Sums                                                                   */
+    /*------------------------------------------------------------------------*/
+    u64 sum_count= 0;
+    for(u32 i= 0; i < count; ++i)
+        sum_count+= glb_normal_merge_chunks(&primitive_list[i]);
+    vec3 *sums= HeapAlloc(process_heap, 0, sizeof(vec3) * sum_count);
+    if(sum_count && !sums) {
+        HeapFree(process_heap, 0, block);
+        return false;
+    }
+    vec3 *sum= sums;
+    job      = job_list;
+    for(u32 i= 0; i < count; ++i) {
+        glb_normal_primitive *primitive= &primitive_list[i];
+        for(u32 c= 0; c < primitive->chunk_count; ++c) {
+            primitive->chunks[c].sums= sum;
+            sum+= primitive->chunks[c].vertex_count;
+            *job++= (glb_normal_job){primitive, c, 1};
+        }
+    }
+    job_dispatch(glb_normal_sum_job, job_list, (u32)(job - job_list));
+    /*------------------------------------------------------------------------*/
+    /* Normals                                                                */
+    /*------------------------------------------------------------------------*/
+    job= job_list;
+    for(u32 i= 0; i < count; ++i) {
+        glb_normal_primitive *primitive= &primitive_list[i];
+        for(u32 first= 0; first < primitive->vertex_count;
+            first+= GLB_NORMAL_VERTEX_RANGE) {
+            u32 range_count= primitive->vertex_count - first;
+            if(range_count > GLB_NORMAL_VERTEX_RANGE)
+                range_count= GLB_NORMAL_VERTEX_RANGE;
+            *job++= (glb_normal_job){primitive, first, range_count};
+        }
+    }
+    job_dispatch(glb_normal_resolve_job, job_list, (u32)(job - job_list));
+    if(sums) HeapFree(process_heap, 0, sums);
+    HeapFree(process_heap, 0, block);
+    return true;
+}
+
+static void
+glb_normal_decode_job(void *user_data, u32 index) {
+    glb_normal_job       *job      = &((glb_normal_job *)user_data)[index];
+    glb_normal_primitive *primitive= job->primitive;
+    vec3                 *positions= primitive->positions + job->first;
+    glb_decode_positions(
+        primitive->vertices + (u64)glb_vertex_size() * job->first,
+        job->count,
+        positions);
+    // Scaling every axis restores the angles of the source, the offset
+    // doesn't change them
+    for(u32 i= 0; i < job->count; ++i) {
+        for(u32 c= 0; c < 3; ++c)
+            positions[i].data[c]*= primitive->pos_scale.data[c];
+    }
+}
+
+/* Replaces the placeholder normals of the converted primitives without a
+ * NORMAL attribute, `vertices` and `indices` point at the model's first
+ * vertex and first index byte. Positions are decoded from the converted
+ * vertices, so quantized formats get the normals of their own positions. */
+static bool
+glb_model_generate_normals(glb_model *model, u8 *vertices, const u8 *indices) {
+    u32 count= 0;
+    u64 size = 0, job_count= 0;
+    for(u32 i= 0; i < model->primitive_count; ++i) {
+        const mesh_primitive_t *primitive= &model->primitive_list[i];
+        if(!model->source_list[i].generate_normals) continue;
+        ++count;
+        size+= sizeof(vec3) * (u64)primitive->vertex_count +
+               sizeof(u32) * (u64)primitive->index_count;
+        job_count+= (primitive->vertex_count + GLB_NORMAL_VERTEX_RANGE - 1) /
+                    GLB_NORMAL_VERTEX_RANGE;
+    }
+    if(!count) return true;
+    f64 start= bench_now();
+    u8 *block= HeapAlloc(
+        process_heap,
+        0,
+        sizeof(glb_normal_primitive) * count +
+            sizeof(glb_normal_job) * job_count + size);
+    if(!block) return false;
+    glb_normal_primitive *primitive_list  = (glb_normal_primitive *)block;
+    glb_normal_primitive *normal_primitive= primitive_list;
+    glb_normal_job       *job_list        =
+        (glb_normal_job *)(primitive_list + count);
+    glb_normal_job *job = job_list;
+    u8             *data= (u8 *)(job_list + job_count);
+    for(u32 i= 0; i < model->primitive_count; ++i) {
+        const mesh_primitive_t *primitive= &model->primitive_list[i];
+        if(!model->source_list[i].generate_normals) continue;
+        vec3 *positions   = (vec3 *)data;
+        u32  *wide_indices= (u32 *)(positions + primitive->vertex_count);
+        data              = (u8 *)(wide_indices + primitive->index_count);
+        u32 index_count   = primitive->index_count;
+        if(model->gltf_json.primitive_list[i].mode != 4) index_count= 0;
+        const u8 *primitive_indices=
+            indices + (u64)primitive->index_size * primitive->index_offset;
+        u8 *primitive_vertices=
+            vertices + (u64)glb_vertex_size() * primitive->vertex_offset;
+        *normal_primitive= (glb_normal_primitive){
+            .indices          = wide_indices,
+            .positions        = positions,
+            .index_count      = index_count,
+            .vertex_count     = primitive->vertex_count,
+            .source_indices   = primitive_indices,
+            .source_index_size= primitive->index_size,
+            .normals          = positions,
+            .vertices         = primitive_vertices,
+            .pos_scale        = primitive->pos_scale};
+        for(u32 first= 0; first < primitive->vertex_count;
+            first+= GLB_NORMAL_VERTEX_RANGE) {
+            u32 range_count= primitive->vertex_count - first;
+            if(range_count > GLB_NORMAL_VERTEX_RANGE)
+                range_count= GLB_NORMAL_VERTEX_RANGE;
+            *job++= (glb_normal_job){normal_primitive, first, range_count};
+        }
+        model->normal_vertex_count+= primitive->vertex_count;
+        model->normal_triangle_count+= index_count / 3;
+        ++normal_primitive;
+    }
+    job_dispatch(glb_normal_decode_job, job_list, (u32)(job - job_list));
+    bool res= glb_generate_normals(primitive_list, count);
+    HeapFree(process_heap, 0, block);
+    model->normal_seconds+= bench_now() - start;
+    return res;
+}
+
+/*============================================================================*/
+/* Vertex Welding                                                             */
+/*============================================================================*/
+typedef struct glb_weld_batch {
+    const glb_model *model;
+    u8              *vertices;
+    const u8        *indices;
+    u32             *wide_indices;
+    const u64       *wide_offsets;  // first element of every primitive
+    u32             *vertex_counts; // welded vertex count of every primitive
+} glb_weld_batch;
+
+/* Primitives the welder can't take, or can't get scratch memory for, keep
+ * all their vertices. */
+static void
+glb_weld_primitive_job(void *user_data, u32 index) {
+    glb_weld_batch         *batch      = user_data;
+    const mesh_primitive_t *primitive  = &batch->model->primitive_list[index];
+    u32                     vertex_size= glb_vertex_size();
+    u32                    *indices    =
+        batch->wide_indices + batch->wide_offsets[index];
+    glb_indices_widen(
+        batch->indices + (u64)primitive->index_size * primitive->index_offset,
+        primitive->index_size,
+        primitive->index_count,
+        indices);
+    batch->vertex_counts[index]= primitive->vertex_count;
+    void *scratch              = HeapAlloc(
+        process_heap,
+        0,
+        mesh_weld_scratch_size(primitive->vertex_count));
+    if(!scratch) return;
+    batch->vertex_counts[index]= mesh_weld_vertices(
+        batch->vertices + (u64)vertex_size * primitive->vertex_offset,
+        vertex_size,
+        primitive->vertex_count,
+        indices,
+        primitive->index_count,
+        scratch);
+    HeapFree(process_heap, 0, scratch);
+}
+
+/* Lays the welded primitives out again, with indices as narrow as their
+ * smaller vertex counts allow, and swaps `vertex_counts` to the source
+ * counts. Remapped indices never grow, so the source width still holds
+ * them. */
+static bool
+glb_model_weld_layout(
+    glb_model *model,
+    const u8  *vertices,
+    const u32 *wide_indices,
+    const u64 *wide_offsets,
+    u32       *vertex_counts) {
+    u32 vertex_size = glb_vertex_size();
+    u64 vertex_count= 0;
+    u64 index_size  = 0;
+    for(u32 i= 0; i < model->primitive_count; ++i) {
+        mesh_primitive_t *primitive= &model->primitive_list[i];
+        u32               size     = glb_min_index_size();
+        if(vertex_counts[i] > 0x100u && size < 2) size= 2;
+        if(vertex_counts[i] > 0x10000u) size= 4;
+        if(size > primitive->index_size) size= primitive->index_size;
+        u32 index_capacity= glb_index_capacity(
+            &model->gltf_json.primitive_list[i],
+            primitive->index_count);
+        u64 index_start= (index_size + size - 1) & ~(u64)(size - 1);
+        primitive->index_size  = size;
+        primitive->index_offset= (u32)(index_start / size);
+        index_size  = index_start + (u64)size * index_capacity;
+        vertex_count+= vertex_counts[i];
+    }
+    index_size= (index_size + 3) & ~3ull;
+    u8 *welded_data=
+        HeapAlloc(process_heap, 0, vertex_size * vertex_count + index_size);
+    if(!welded_data) return false;
+    u8 *welded_indices= welded_data + vertex_size * vertex_count;
+    u64 first_vertex  = 0;
+    for(u32 i= 0; i < model->primitive_count; ++i) {
+        mesh_primitive_t *primitive= &model->primitive_list[i];
+        u32               count    = vertex_counts[i];
+        __movsb(
+            welded_data + (u64)vertex_size * first_vertex,
+            vertices + (u64)vertex_size * primitive->vertex_offset,
+            (u64)vertex_size * count);
+        glb_indices_narrow(
+            wide_indices + wide_offsets[i],
+            primitive->index_size,
+            primitive->index_count,
+            welded_indices +
+                (u64)primitive->index_size * primitive->index_offset);
+        vertex_counts[i]        = primitive->vertex_count;
+        primitive->vertex_count = count;
+        primitive->vertex_offset= (u32)first_vertex;
+        first_vertex+= count;
+    }
+    model->vertex_count= vertex_count;
+    model->index_size  = index_size;
+    model->welded_data = welded_data;
+    glb_clear_index_padding(model, welded_indices);
+    return true;
+}
+
+/* Converts the model ahead of the staging buffer and merges the duplicate
+ * vertices of every primitive, the welded sizes replace the model's so the
+ * buffers are allocated for the welded model. */
+static bool
+glb_model_weld(glb_model *model) {
+    u32 vertex_size  = glb_vertex_size();
+    u64 vertices_size= (u64)vertex_size * model->vertex_count;
+    u64 index_count  = 0;
+    for(u32 i= 0; i < model->primitive_count; ++i)
+        index_count+= model->primitive_list[i].index_count;
+    u8  *data= HeapAlloc(process_heap, 0, vertices_size + model->index_size);
+    u32 *wide_indices=
+        HeapAlloc(process_heap, 0, sizeof(u32) * index_count);
+    u64 *wide_offsets=
+        HeapAlloc(process_heap, 0, sizeof(u64) * model->primitive_count);
+    u32 *vertex_counts=
+        HeapAlloc(process_heap, 0, sizeof(u32) * model->primitive_count);
+    bool res= data && wide_indices && wide_offsets && vertex_counts &&
+              glb_model_convert(model, data, data + vertices_size) &&
+              glb_model_generate_normals(model, data, data + vertices_size);
+    if(res) {
+        u64 offset= 0;
+        for(u32 i= 0; i < model->primitive_count; ++i) {
+            wide_offsets[i]= offset;
+            offset+= model->primitive_list[i].index_count;
+        }
+        glb_weld_batch batch= {
+            .model        = model,
+            .vertices     = data,
+            .indices      = data + vertices_size,
+            .wide_indices = wide_indices,
+            .wide_offsets = wide_offsets,
+            .vertex_counts= vertex_counts};
+        if(model->primitive_count > 1 && job_system_thread_count() > 1) {
+            job_dispatch(
+                glb_weld_primitive_job,
+                &batch,
+                model->primitive_count);
+        } else {
+            for(u32 i= 0; i < model->primitive_count; ++i)
+                glb_weld_primitive_job(&batch, i);
+        }
+        res= glb_model_weld_layout(
+            model,
+            data,
+            wide_indices,
+            wide_offsets,
+            vertex_counts);
+    }
+    if(res) {
+        model->unwelded_vertex_counts= vertex_counts;
+        vertex_counts                = null;
+    }
+    if(data) HeapFree(process_heap, 0, data);
+    if(wide_indices) HeapFree(process_heap, 0, wide_indices);
+    if(wide_offsets) HeapFree(process_heap, 0, wide_offsets);
+    if(vertex_counts) HeapFree(process_heap, 0, vertex_counts);
+    return res;
+}
+
+/*============================================================================*/
+/* Clusters                                                                   */
+/*============================================================================*/
+static void
+glb_model_free_clusters(glb_model *model) {
+    if(model->cluster_memory)
+        HeapFree(process_heap, 0, model->cluster_memory);
+    if(model->cluster_counts)
+        HeapFree(process_heap, 0, model->cluster_counts);
+    model->clusters      = (mesh_cluster_list){0};
+    model->cluster_memory= null;
+    model->cluster_counts= null;
+}
+
+/* Splits the triangle lists of the converted model into clusters, the first
+ * pass counts them and the second writes them. */
+static bool
+glb_model_build_clusters(
+    glb_model *model,
+    const u8  *vertices,
+    const u8  *indices) {
+    u32 vertex_size= glb_vertex_size();
+    u64 block_size = 0;
+    for(u32 i= 0; i < model->primitive_count; ++i) {
+        const mesh_primitive_t *primitive= &model->primitive_list[i];
+        u64 size= sizeof(u32) * (u64)primitive->index_count +
+                  (sizeof(u32) + sizeof(vec3)) * (u64)primitive->vertex_count;
+        if(size > block_size) block_size= size;
+    }
+    model->cluster_counts= HeapAlloc(
+        process_heap,
+        HEAP_ZERO_MEMORY,
+        sizeof(u32) * model->primitive_count);
+    u8  *block= block_size ? HeapAlloc(process_heap, 0, block_size) : null;
+    bool res  = (model->cluster_counts || !model->primitive_count) &&
+               (block || !block_size);
+    u32 cluster_count= 0;
+    for(u32 pass= 0; res && pass < 2; ++pass) {
+        if(pass == 1) {
+            if(!cluster_count) break;
+            model->cluster_memory= HeapAlloc(
+                process_heap,
+                0,
+                mesh_cluster_list_size(cluster_count));
+            if(!model->cluster_memory) {
+                res= false;
+                break;
+            }
+            mesh_cluster_list_init(
+                &model->clusters,
+                model->cluster_memory,
+                cluster_count);
+            cluster_count= 0;
+        }
+        for(u32 i= 0; i < model->primitive_count; ++i) {
+            const mesh_primitive_t *primitive= &model->primitive_list[i];
+            if(model->gltf_json.primitive_list[i].mode != 4) continue;
+            if(pass == 1 && !model->cluster_counts[i]) continue;
+            u32  *wide_indices= (u32 *)block;
+            u32  *scratch     = wide_indices + primitive->index_count;
+            vec3 *positions   = (vec3 *)(scratch + primitive->vertex_count);
+            glb_indices_widen(
+                indices + (u64)primitive->index_size * primitive->index_offset,
+                primitive->index_size,
+                primitive->index_count,
+                wide_indices);
+            if(pass == 1) {
+                glb_decode_positions(
+                    vertices + (u64)vertex_size * primitive->vertex_offset,
+                    primitive->vertex_count,
+                    positions);
+            }
+            model->cluster_counts[i]= mesh_build_clusters(
+                wide_indices,
+                primitive->index_count,
+                primitive->vertex_count,
+                positions,
+                scratch,
+                pass == 1 ? &model->clusters : null,
+                cluster_count);
+            cluster_count+= model->cluster_counts[i];
+        }
+    }
+    if(block) HeapFree(process_heap, 0, block);
+    if(!res) glb_model_free_clusters(model);
+    return res;
+}
+
+/*============================================================================*/
+/* Levels of Detail                                                           */
+/*============================================================================*/
+// Levels with a smaller triangle budget aren't generated
+#define GLB_LOD_MIN_TRIANGLES 64u
+
+typedef struct glb_lod_batch {
+    glb_model *model;
+    const u8  *vertices;
+    u8        *indices;
+} glb_lod_batch;
+
+/* Simplifies every level from the one before it, so each level only works
+ * through half the triangles of the last and its error is the sum of the
+ * errors so far. The chain ends at the first level that misses its budget.
+ * Primitives the simplifier can't take, or can't get scratch memory for,
+ * keep their full range only. */
+static void
+glb_lod_primitive_job(void *user_data, u32 index) {
+    glb_lod_batch    *batch       = user_data;
+    mesh_primitive_t *primitive   = &batch->model->primitive_list[index];
+    u32               index_count = primitive->index_count;
+    u32               vertex_count= primitive->vertex_count;
+    if(batch->model->gltf_json.primitive_list[index].mode != 4 ||
+       glb_lod_index_count(index_count, 0) / 3 < GLB_LOD_MIN_TRIANGLES)
+        return;
+    u64 scratch_size = mesh_simplify_scratch_size(index_count, vertex_count);
+    u64 optimize_size= mesh_optimize_scratch_size(
+        glb_lod_index_count(index_count, 0),
+        vertex_count);
+    if(optimize_size > scratch_size) scratch_size= optimize_size;
+    u8 *block= HeapAlloc(
+        process_heap,
+        0,
+        sizeof(u32) * (u64)index_count + sizeof(vec3) * (u64)vertex_count +
+            scratch_size);
+    if(!block) return;
+    u32  *wide_indices= (u32 *)block;
+    vec3 *positions   = (vec3 *)(wide_indices + index_count);
+    void *scratch     = positions + vertex_count;
+    u8   *primitive_indices=
+        batch->indices + (u64)primitive->index_size * primitive->index_offset;
+    glb_indices_widen(
+        primitive_indices,
+        primitive->index_size,
+        index_count,
+        wide_indices);
+    if(!mesh_triangles_valid(wide_indices, index_count, vertex_count)) {
+        HeapFree(process_heap, 0, block);
+        return;
+    }
+    glb_decode_positions(
+        batch->vertices + (u64)glb_vertex_size() * primitive->vertex_offset,
+        vertex_count,
+        positions);
+    vec3 aabb_min= positions[0];
+    vec3 aabb_max= positions[0];
+    for(u32 v= 1; v < vertex_count; ++v) {
+        for(u32 c= 0; c < 3; ++c) {
+            f32 value= positions[v].data[c];
+            if(value < aabb_min.data[c]) aabb_min.data[c]= value;
+            if(value > aabb_max.data[c]) aabb_max.data[c]= value;
+        }
+    }
+    f32 radius_squared= 0.F;
+    for(u32 c= 0; c < 3; ++c) {
+        f32 half_extent= (aabb_max.data[c] - aabb_min.data[c]) * 0.5F;
+        primitive->bounds.data[c]= aabb_min.data[c] + half_extent;
+        radius_squared+= half_extent * half_extent;
+    }
+    primitive->bounds.w= sqrt_f32(radius_squared);
+    u32 first_index= primitive->index_count;
+    f32 error      = 0.F;
+    for(u32 level= 0; level < MESH_LOD_COUNT; ++level) {
+        u32 budget= glb_lod_index_count(primitive->index_count, level);
+        if(budget / 3 < GLB_LOD_MIN_TRIANGLES) break;
+        f32 level_error;
+        index_count= mesh_simplify(
+            wide_indices,
+            index_count,
+            positions,
+            vertex_count,
+            budget,
+            scratch,
+            &level_error);
+        if(index_count > budget) break;
+        if(load_options.optimize_meshes) {
+            mesh_optimize_vertex_cache(
+                wide_indices,
+                index_count,
+                vertex_count,
+                scratch);
+        }
+        glb_indices_narrow(
+            wide_indices,
+            primitive->index_size,
+            index_count,
+            primitive_indices + (u64)primitive->index_size * first_index);
+        error+= level_error;
+        primitive->lod_list[level]=
+            (mesh_lod_t){first_index, index_count, error};
+        primitive->lod_count= level + 1;
+        first_index+= budget;
+    }
+    HeapFree(process_heap, 0, block);
+}
+
+/* Fills the index budget behind every triangle list with its levels of
+ * detail, one job per primitive. Runs on the converted and optimized
+ * staging range, so the levels go into the cache with the rest. */
+static void
+glb_model_build_lods(glb_model *model, const u8 *vertices, u8 *indices) {
+    glb_lod_batch batch= {model, vertices, indices};
+    f64           start= bench_now();
+    if(model->primitive_count > 1 && job_system_thread_count() > 1) {
+        job_dispatch(glb_lod_primitive_job, &batch, model->primitive_count);
+    } else {
+        for(u32 i= 0; i < model->primitive_count; ++i)
+            glb_lod_primitive_job(&batch, i);
+    }
+    model->lod_seconds= bench_now() - start;
+    for(u32 i= 0; i < model->primitive_count; ++i) {
+        const mesh_primitive_t *primitive= &model->primitive_list[i];
+        if(!primitive->lod_count) continue;
+        model->lod_triangle_counts[0]+= primitive->index_count / 3;
+        for(u32 level= 0; level < primitive->lod_count; ++level) {
+            model->lod_triangle_counts[level + 1]+=
+                primitive->lod_list[level].index_count / 3;
+        }
+    }
+}
+
+static void
+glb_model_open_job(void *user_data, u32 index) {
+    glb_model *model= &((glb_model *)user_data)[index];
+    model->loaded   = glb_model_open(model);
+    if(model->loaded && load_options.weld_vertices && !model->cache.view)
+        model->loaded= glb_model_weld(model);
+    if(!model->loaded) glb_model_close(model);
+}
+
+typedef struct glb_model_convert_batch {
+    glb_model *model_list;
+    u8        *vertices;
+    u8        *indices;
+} glb_model_convert_batch;
+
+static void
+glb_model_convert_job(void *user_data, u32 index) {
+    glb_model_convert_batch *batch= user_data;
+    glb_model               *model= &batch->model_list[index];
+    if(!model->loaded) return;
+    u8 *vertices= batch->vertices + glb_vertex_size() * model->first_vertex;
+    u8 *indices = batch->indices + model->index_offset;
+    model->loaded= glb_model_convert(model, vertices, indices);
+    // Welded vertices got their normals before they were merged
+    if(model->loaded && !model->cache.view && !model->welded_data)
+        model->loaded= glb_model_generate_normals(model, vertices, indices);
+    if(model->loaded && load_options.optimize_meshes && !model->cache.view)
+        model->loaded= glb_model_optimize(model, vertices, indices);
+    if(model->loaded && load_options.generate_lods && !model->cache.view)
+        glb_model_build_lods(model, vertices, indices);
+    // Reads the converted range back from staging once, later loads skip the
+    // whole conversion
+    if(model->loaded && model->cache_path && !model->cache.view)
+        glb_model_store_cache(model, vertices, indices);
+    if(model->loaded && load_options.cluster_culling)
+        model->loaded= glb_model_build_clusters(model, vertices, indices);
+    glb_model_close(model);
+}
+
+/* Appends `path` to the model list, a directory adds every .glb inside it.
+ * Returns false when an allocation fails, the list keeps the models
+ * collected before. */
+static bool
+glb_collect_models(LPCWSTR path, glb_model **model_list, u32 *model_count) {
+    DWORD attributes= GetFileAttributes(path);
+    if(attributes == INVALID_FILE_ATTRIBUTES) return true;
+    if(!(attributes & FILE_ATTRIBUTE_DIRECTORY)) {
+        if(!*model_list || (*model_count & (*model_count - 1)) == 0) {
+            u32        capacity= *model_count ? *model_count * 2 : 1;
+            glb_model *list    = HeapAlloc(
+                process_heap,
+                HEAP_ZERO_MEMORY,
+                sizeof(glb_model) * capacity);
+            if(!list) return false;
+            for(u32 i= 0; i < *model_count; ++i) list[i]= (*model_list)[i];
+            if(*model_list) HeapFree(process_heap, 0, *model_list);
+            *model_list= list;
+        }
+        (*model_list)[(*model_count)++].file_path= path;
+        return true;
+    }
+    u32    path_length= lstrlenW(path);
+    LPWSTR pattern    = HeapAlloc(
+        process_heap,
+        HEAP_ZERO_MEMORY,
+        sizeof(WCHAR) * (path_length + 8));
+    if(!pattern) return false;
+    lstrcpyW(pattern, path);
+    lstrcatW(pattern, L"\\*.glb");
+    WIN32_FIND_DATA find_data;
+    HANDLE          find_handle= FindFirstFile(pattern, &find_data);
+    HeapFree(process_heap, 0, pattern);
+    if(find_handle == INVALID_HANDLE_VALUE) return true;
+    bool res= true;
+    do {
+        if(find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) continue;
+        LPWSTR file_path= HeapAlloc(
+            process_heap,
+            HEAP_ZERO_MEMORY,
+            sizeof(WCHAR) * (path_length + lstrlenW(find_data.cFileName) + 2));
+        if(!file_path) {
+            res= false;
+            break;
+        }
+        lstrcpyW(file_path, path);
+        lstrcatW(file_path, L"\\");
+        lstrcatW(file_path, find_data.cFileName);
+        // A collected path belongs to its model, one that wasn't goes
+        res= glb_collect_models(file_path, model_list, model_count);
+        if(!res) HeapFree(process_heap, 0, file_path);
+    } while(res && FindNextFile(find_handle, &find_data));
+    FindClose(find_handle);
+    return res;
+}
+
+/*============================================================================*/
+/* Benchmarks                                                                 */
+/*============================================================================*/
+#define GLB_BENCH_MIN_SECONDS  0.5
+#define GLB_BENCH_JSMN_MAX_SIZE (4ull << 20)
+
+static u64
+glb_bench_append(char *out, u64 at, const char *str) {
+    while(*str) out[at++]= *str++;
+    return at;
+}
+
+/* Tokenizes the same chunk with every tokenizer the CPU supports for at
+ * least GLB_BENCH_MIN_SECONDS each. Without parent links jsmn walks back over
+ * all earlier tokens at every closing bracket, which is quadratic in the
+ * length of an array, so it sits out the large chunks. */
+static void
+glb_bench_tokenizers(const char *name, const char *json_data, u64 json_length) {
+    static const char *const tokenizer_names[]= {
+        "  jsmn",
+        "  scan sse2",
+        "  scan avx2"};
+    gltf_tokenizer last_tokenizer= gltf_tokenizer_scan_sse2;
+    if(json_scan_best_isa() == json_scan_isa_avx2)
+        last_tokenizer= gltf_tokenizer_scan_avx2;
+    gltf_token_arena *arena= &gltf_token_arenas[0];
+    bench_print(name);
+    bench_print(", ");
+    bench_print_u64(json_length);
+    bench_print(" bytes, ");
+    bench_print_u64(gltf_tokenize_json(
+        arena,
+        json_data,
+        json_length,
+        last_tokenizer));
+    bench_print(" tokens\n");
+    for(u32 tokenizer= 0; tokenizer <= last_tokenizer; ++tokenizer) {
+        if(tokenizer == gltf_tokenizer_jsmn &&
+           json_length > GLB_BENCH_JSMN_MAX_SIZE) {
+            bench_print(tokenizer_names[tokenizer]);
+            bench_print(": skipped\n");
+            continue;
+        }
+        u64 bytes  = 0;
+        f64 start  = bench_now();
+        f64 elapsed= 0.0;
+        do {
+            if(!gltf_tokenize_json(arena, json_data, json_length, tokenizer)) {
+                bench_print(tokenizer_names[tokenizer]);
+                bench_print(": failed\n");
+                break;
+            }
+            bytes+= json_length;
+            elapsed= bench_now() - start;
+        } while(elapsed < GLB_BENCH_MIN_SECONDS);
+        if(bytes)
+            bench_report_throughput(tokenizer_names[tokenizer], bytes, elapsed);
+    }
+}
+
+/* JSON chunk of about `size` bytes made of accessors, in the compact form
+ * and in the indented form most exporters write. */
+static char *
+glb_bench_synthetic_json(bool indented, u64 size, u64 *out_length) {
+    static const char *const accessor[2]= {
+        "{\"bufferView\":0,\"componentType\":5126,\"count\":24,"
+        "\"max\":[1.0,1.0,1.0],\"min\":[-1.0,-1.0,-1.0],\"type\":\"VEC3\"}",
+        "\n        {\n            \"bufferView\" : 0,\n"
+        "            \"componentType\" : 5126,\n"
+        "            \"count\" : 24,\n"
+        "            \"max\" : [\n                1.0,\n"
+        "                1.0,\n                1.0\n            ],\n"
+        "            \"min\" : [\n                -1.0,\n"
+        "                -1.0,\n                -1.0\n            ],\n"
+        "            \"type\" : \"VEC3\"\n        }"};
+    u64   capacity= size + 4096;
+    char *json    = HeapAlloc(process_heap, 0, capacity);
+    if(!json) return null;
+    u64 length= glb_bench_append(
+        json,
+        0,
+        "{\"asset\":{\"version\":\"2.0\"},\"accessors\":[");
+    for(u32 i= 0; length < size; ++i) {
+        if(i) length= glb_bench_append(json, length, ",");
+        length= glb_bench_append(json, length, accessor[indented]);
+    }
+    length     = glb_bench_append(json, length, "]}");
+    *out_length= length;
+    return json;
+}
+
+/* Full parse of a chunk, once with every section and once with only the
+ * sections needed to build geometry, each through the process heap and
+ * through an arena that is reset after every parse. */
+static void
+glb_bench_sections(const char *json_data, u64 json_length) {
+    static const char *const section_names[4]= {
+        "  parse all sections, heap",
+        "  parse all sections, arena",
+        "  parse geometry sections, heap",
+        "  parse geometry sections, arena"};
+    static const u32 section_masks[2]= {
+        GLTF_JSON_SECTIONS_ALL,
+        GLTF_JSON_SECTIONS_GEOMETRY};
+    gltf_arena arena= {.zero_memory= true};
+    for(u32 i= 0; i < 4; ++i) {
+        bool           use_arena= i & 1;
+        gltf_allocator allocator= g_allocator;
+        if(use_arena) allocator= gltf_arena_allocator(&arena);
+        u64 bytes  = 0;
+        f64 start  = bench_now();
+        f64 elapsed= 0.0;
+        do {
+            gltf_json_data gltf_json= {0};
+            gltf_parse_json(
+                &gltf_json,
+                json_data,
+                json_length,
+                &gltf_token_arenas[0],
+                section_masks[i >> 1],
+                &allocator);
+            gltf_free_json(&gltf_json, &allocator);
+            if(use_arena) gltf_arena_reset(&arena);
+            bytes+= json_length;
+            elapsed= bench_now() - start;
+        } while(elapsed < GLB_BENCH_MIN_SECONDS);
+        bench_report_throughput(section_names[i], bytes, elapsed);
+        if(use_arena) {
+            bench_print("    arena high water: ");
+            bench_print_u64(arena.last_high_water);
+            bench_print(" bytes\n");
+        }
+    }
+    gltf_arena_release(&arena);
+}
+
+static u64
+glb_bench_random(u64 *state) {
+    *state^= *state << 13;
+    *state^= *state >> 7;
+    *state^= *state << 17;
+    return *state;
+}
+
+/* Comma separated JSON numbers ranging from short literals to 17 significant
+ * digits with an exponent, `offset_list` gets the start of every number and
+ * the end of the text. */
+static char *
+glb_bench_float_text(u32 *offset_list, u32 count, u64 *out_length) {
+    char *text= HeapAlloc(process_heap, 0, (u64)count * 32 + 1);
+    if(!text) return null;
+    u64 state = 0x9E3779B97F4A7C15ull;
+    u64 length= 0;
+    for(u32 i= 0; i < count; ++i) {
+        u64 shape      = glb_bench_random(&state);
+        u32 digit_count= 1 + (u32)(shape % 17);
+        u32 point      = 1 + (u32)(shape >> 8) % digit_count;
+        offset_list[i] = (u32)length;
+        if(shape >> 63) text[length++]= '-';
+        for(u32 d= 0; d < digit_count; ++d) {
+            if(d == point) text[length++]= '.';
+            u32 digit= (u32)(glb_bench_random(&state) % 10);
+            if(!d && !digit) digit= 1;
+            text[length++]= (char)('0' + digit);
+        }
+        if((shape >> 16) % 4 == 0) {
+            u32 exponent= (u32)(shape >> 24) % 31;
+            text[length++]= 'e';
+            if(shape >> 62 & 1) text[length++]= '-';
+            if(exponent >= 10) text[length++]= (char)('0' + exponent / 10);
+            text[length++]= (char)('0' + exponent % 10);
+        }
+        text[length++]= ',';
+    }
+    offset_list[count]= (u32)length;
+    text[length]      = 0;
+    *out_length       = length;
+    return text;
+}
+
+/* Interleaves the same POSITION and NORMAL data into `vertex` with every
+ * kernel the CPU supports and quantizes it into both compact layouts. */
+static void
+glb_bench_vertices(
+    const char *name,
+    const vec3 *pos_data,
+    const vec3 *nrm_data,
+    u32         count) {
+    static const char *const isa_names[3]= {
+        "  scalar vertex convert",
+        "  sse2 vertex convert",
+        "  avx2 vertex convert"};
+    vertex *vertices= HeapAlloc(process_heap, 0, sizeof(vertex) * count);
+    if(!vertices) return;
+    bench_print(name);
+    bench_print(", ");
+    bench_print_u64(count);
+    bench_print(" vertices\n");
+    // Faults the output pages in before anything is timed
+    vertex_convert(
+        vertex_convert_isa_scalar,
+        pos_data,
+        nrm_data,
+        count,
+        vertices);
+    vertex_convert_isa best_isa= vertex_convert_best_isa();
+    for(u32 isa= 0; isa <= best_isa; ++isa) {
+        u64 converted= 0;
+        f64 start    = bench_now();
+        f64 elapsed  = 0.0;
+        do {
+            vertex_convert(isa, pos_data, nrm_data, count, vertices);
+            converted+= count;
+            elapsed= bench_now() - start;
+        } while(elapsed < GLB_BENCH_MIN_SECONDS);
+        bench_print(isa_names[isa]);
+        bench_print(": ");
+        bench_print_f64((f64)converted / elapsed / 1e6, 3);
+        bench_print(" Mvertices/s, ");
+        bench_print_f64(
+            (f64)converted * (sizeof(vertex) + 2 * sizeof(vec3)) / elapsed /
+                1e9,
+            3);
+        bench_print(" GB/s read and written\n");
+    }
+    static const char *const format_names[2]= {
+        "  oct16 vertex quantize",
+        "  oct8 vertex quantize"};
+    vec3 offset= vec3_make(0.F, 0.F, 0.F);
+    vec3 scale = vec3_make(1.F, 1.F, 1.F);
+    for(u32 format= vertex_format_oct16; format <= vertex_format_oct8;
+        ++format) {
+        u64 converted= 0;
+        f64 start    = bench_now();
+        f64 elapsed  = 0.0;
+        do {
+            vertex_quantize(
+                format,
+                pos_data,
+                nrm_data,
+                count,
+                &offset,
+                &scale,
+                vertices);
+            converted+= count;
+            elapsed= bench_now() - start;
+        } while(elapsed < GLB_BENCH_MIN_SECONDS);
+        bench_print(format_names[format - vertex_format_oct16]);
+        bench_print(": ");
+        bench_print_f64((f64)converted / elapsed / 1e6, 3);
+        bench_print(" Mvertices/s, ");
+        bench_print_f64(
+            (f64)converted * (vertex_format_size(format) + 2 * sizeof(vec3)) /
+                elapsed / 1e9,
+            3);
+        bench_print(" GB/s read and written\n");
+    }
+    HeapFree(process_heap, 0, vertices);
+}
+
+/* Every triangle primitive of a mapped model through glb_bench_vertices,
+ * attributes that aren't packed float3 are decoded up front. */
+static void
+glb_bench_model_vertices(const glb_mapped_file *mapped_file) {
+    gltf_json_data gltf_json= {0};
+    gltf_parse_json(
+        &gltf_json,
+        mapped_file->json_data,
+        mapped_file->json_length,
+        &gltf_token_arenas[0],
+        GLTF_JSON_SECTIONS_GEOMETRY,
+        &g_allocator);
+    gltf_release_json_index(&gltf_json);
+    for(u32 i= 0; i < gltf_json.primitive_count; ++i) {
+        gltf_mesh_primitive *gltf_primitive= &gltf_json.primitive_list[i];
+        accessor_decoder     pos_decoder, nrm_decoder;
+        u64                  pos_offset, nrm_offset;
+        if(!glb_accessor_decoder(
+               &gltf_json,
+               gltf_primitive->pos_accessor,
+               accessor_target_vec3,
+               &pos_decoder,
+               &pos_offset) ||
+           !glb_accessor_decoder(
+               &gltf_json,
+               gltf_primitive->nrm_accessor,
+               accessor_target_vec3,
+               &nrm_decoder,
+               &nrm_offset))
+            continue;
+        u32 count= gltf_json.accessor_list[gltf_primitive->pos_accessor].count;
+        const u8 *pos_data= mapped_file->bin_data + pos_offset;
+        const u8 *nrm_data= mapped_file->bin_data + nrm_offset;
+        if(pos_decoder.passthrough && nrm_decoder.passthrough) {
+            glb_bench_vertices(
+                "  mesh primitive",
+                (const vec3 *)pos_data,
+                (const vec3 *)nrm_data,
+                count);
+            continue;
+        }
+        vec3 *attribute_data=
+            HeapAlloc(process_heap, 0, sizeof(vec3) * 2 * (u64)count);
+        if(!attribute_data) continue;
+        accessor_decode(&pos_decoder, pos_data, count, attribute_data);
+        accessor_decode(&nrm_decoder, nrm_data, count, attribute_data + count);
+        glb_bench_vertices(
+            "  decoded mesh primitive",
+            attribute_data,
+            attribute_data + count,
+            count);
+        HeapFree(process_heap, 0, attribute_data);
+    }
+    gltf_free_json(&gltf_json, &g_allocator);
+}
+
+/* Random attributes for meshes larger than any sample model. */
+static void
+glb_bench_synthetic_vertices(u32 count) {
+    vec3 *attribute_data= HeapAlloc(process_heap, 0, sizeof(vec3) * 2 * count);
+    if(!attribute_data) return;
+    u64  state= 0x9E3779B97F4A7C15ull;
+    f32 *value= (f32 *)attribute_data;
+    for(u64 i= 0; i < 6ull * count; ++i)
+        value[i]= (f32)(glb_bench_random(&state) >> 40) / (f32)(1u << 24);
+    glb_bench_vertices(
+        "synthetic mesh",
+        attribute_data,
+        attribute_data + count,
+        count);
+    HeapFree(process_heap, 0, attribute_data);
+}
+
+/* `size` x `size` vertices of noisy height and two triangles per quad, in
+ * row order. */
+static void
+glb_bench_height_field(u32 size, vec3 *positions, u32 *indices) {
+    u64 state= 0x9E3779B97F4A7C15ull;
+    for(u32 y= 0; y < size; ++y) {
+        for(u32 x= 0; x < size; ++x) {
+            f32 noise= (f32)(glb_bench_random(&state) >> 40) / (f32)(1u << 24);
+            positions[y * size + x]= vec3_make(
+                (f32)x / (f32)size,
+                (f32)y / (f32)size,
+                noise * 0.5F / (f32)size);
+        }
+    }
+    for(u32 y= 0; y + 1 < size; ++y) {
+        for(u32 x= 0; x + 1 < size; ++x) {
+            u32 corner= y * size + x;
+            *indices++= corner;
+            *indices++= corner + 1;
+            *indices++= corner + size;
+            *indices++= corner + 1;
+            *indices++= corner + size + 1;
+            *indices++= corner + size;
+        }
+    }
+}
+
+typedef struct glb_bench_simplify_batch {
+    const u32  *indices;
+    const vec3 *positions;
+    u32         index_count;
+    u32         vertex_count;
+    u8         *memory; // working indices and scratch of every job
+    u64         job_size;
+    f32         error; // of the first job
+} glb_bench_simplify_batch;
+
+static void
+glb_bench_simplify_job(void *user_data, u32 index) {
+    glb_bench_simplify_batch *batch  = user_data;
+    u32                      *indices=
+        (u32 *)(batch->memory + batch->job_size * index);
+    __movsb(
+        (u8 *)indices,
+        (const u8 *)batch->indices,
+        sizeof(u32) * (u64)batch->index_count);
+    f32 error;
+    mesh_simplify(
+        indices,
+        batch->index_count,
+        batch->positions,
+        batch->vertex_count,
+        glb_lod_index_count(batch->index_count, 1),
+        indices + batch->index_count,
+        &error);
+    if(!index) batch->error= error;
+}
+
+/* A noisy height field of `size` x `size` vertices simplified to a quarter
+ * of its triangles, on one thread and as one copy on every thread. */
+static void
+glb_bench_simplify(u32 size) {
+    u32 thread_count= job_system_thread_count();
+    u32 vertex_count= size * size;
+    u32 index_count = 6 * (size - 1) * (size - 1);
+    u64 job_size    = mesh_simplify_scratch_size(index_count, vertex_count);
+    job_size= (job_size + sizeof(u32) * (u64)index_count + 63) & ~63ull;
+    vec3 *positions= HeapAlloc(
+        process_heap,
+        0,
+        sizeof(vec3) * (u64)vertex_count + sizeof(u32) * (u64)index_count);
+    u8 *memory= HeapAlloc(process_heap, 0, job_size * thread_count);
+    if(!positions || !memory) {
+        if(positions) HeapFree(process_heap, 0, positions);
+        if(memory) HeapFree(process_heap, 0, memory);
+        return;
     }
-    if(out) {
-        out->primitive_count= mesh.primitive_count;
-        out->primitive_list = mesh.primitive_list;
+    u32 *indices= (u32 *)(positions + vertex_count);
+    glb_bench_height_field(size, positions, indices);
+    glb_bench_simplify_batch batch= {
+        .indices     = indices,
+        .positions   = positions,
+        .index_count = index_count,
+        .vertex_count= vertex_count,
+        .memory      = memory,
+        .job_size    = job_size};
+    bench_print("synthetic height field, ");
+    bench_print_u64(index_count / 3);
+    bench_print(" triangles to a quarter\n");
+    for(u32 parallel= 0; parallel < 2; ++parallel) {
+        u32 job_count = parallel ? thread_count : 1;
+        u64 simplified= 0;
+        f64 start     = bench_now();
+        f64 elapsed   = 0.0;
+        do {
+            if(job_count > 1)
+                job_dispatch(glb_bench_simplify_job, &batch, job_count);
+            else glb_bench_simplify_job(&batch, 0);
+            simplified+= (u64)job_count * (index_count / 3);
+            elapsed= bench_now() - start;
+        } while(elapsed < GLB_BENCH_MIN_SECONDS);
+        bench_print(parallel ? "  simplify, all threads: " :
+                               "  simplify, one thread: ");
+        bench_print_f64((f64)simplified / elapsed / 1e6, 3);
+        bench_print(" Mtriangles/s\n");
     }
-    return key_token;
+    // With the noise scaled down the reduction deviates mildly, the quadric
+    // terms cancel down to an error far below them, and it has to come out
+    // the same with the field tilted away from the axes
+    f32 errors[2];
+    for(u32 tilted= 0; tilted < 2; ++tilted) {
+        for(u32 v= 0; v < vertex_count; ++v) {
+            vec3 *position= &positions[v];
+            if(tilted) position->z+= 0.7F * (position->x + position->y);
+            else position->z*= 1.F / 64.F;
+        }
+        glb_bench_simplify_job(&batch, 0);
+        errors[tilted]= batch.error;
+    }
+    bench_print("  simplify error: ");
+    bench_print_f64(errors[0], 8);
+    bench_print(", tilted: ");
+    bench_print_f64(errors[1], 8);
+    if(!(errors[0] > 0.F && errors[1] > errors[0] * 0.25F &&
+         errors[1] < errors[0] * 4.F))
+        bench_print(", FAILED");
+    bench_print("\n");
+    HeapFree(process_heap, 0, memory);
+    HeapFree(process_heap, 0, positions);
 }
 
-static jsmntok_t *
-gltf_parse_scene(void *out, jsmntok_t *scene_token, const char *json_data) {
-    jsmntok_t *key_token  = &scene_token[1];
-    jsmntok_t *value_token= &scene_token[2];
-    for(u32 i= 0; i < scene_token->size; ++i) {
-        const char *key_str  = &json_data[key_token->start];
-        const char *value_str= &json_data[value_token->start];
-        u64         value_len= value_token->end - value_token->start;
-        if(compare_string_utf8(key_str, 4, "name")) {
-            key_token= value_token + 1;
-        } else if(compare_string_utf8(key_str, 5, "nodes")) {
-            jsmntok_t *out_token= &key_token[2];
-            for(u32 i= 0; i < value_token->size; ++i) { ++out_token; }
-            key_token= out_token;
-        }
-        value_token= key_token + 1;
+/* Smooth normals of a noisy height field of `size` x `size` vertices, on
+ * all threads. The bytes are the indices and positions read and the normals
+ * written, the chunk sums come on top. */
+static void
+glb_bench_normals(u32 size) {
+    u32   vertex_count= size * size;
+    u32   index_count = 6 * (size - 1) * (size - 1);
+    vec3 *positions   = HeapAlloc(
+        process_heap,
+        0,
+        2 * sizeof(vec3) * (u64)vertex_count + sizeof(u32) * (u64)index_count);
+    if(!positions) return;
+    vec3 *normals= positions + vertex_count;
+    u32  *indices= (u32 *)(normals + vertex_count);
+    glb_bench_height_field(size, positions, indices);
+    glb_normal_primitive primitive= {
+        .indices     = indices,
+        .positions   = positions,
+        .index_count = index_count,
+        .vertex_count= vertex_count,
+        .normals     = normals};
+    bench_print("synthetic height field, ");
+    bench_print_u64(index_count / 3);
+    bench_print(" triangles\n");
+    u64 generated= 0;
+    f64 start    = bench_now();
+    f64 elapsed  = 0.0;
+    do {
+        if(!glb_generate_normals(&primitive, 1)) break;
+        ++generated;
+        elapsed= bench_now() - start;
+    } while(elapsed < GLB_BENCH_MIN_SECONDS);
+    if(generated) {
+        u64 bytes= sizeof(u32) * (u64)index_count +
+                   2 * sizeof(vec3) * (u64)vertex_count;
+        bench_report_throughput(
+            "  normals, all threads",
+            generated * bytes,
+            elapsed);
+        bench_print("  normals, all threads: ");
+        bench_print_f64((f64)generated * (index_count / 3) / elapsed / 1e6, 3);
+        bench_print(" Mtriangles/s\n");
     }
-    return key_token;
+    HeapFree(process_heap, 0, positions);
 }
 
-static jsmntok_t *
-gltf_parse_node(void *out, jsmntok_t *node_token, const char *json_data) {
-    jsmntok_t *key_token  = &node_token[1];
-    jsmntok_t *value_token= &node_token[2];
-    for(u32 i= 0; i < node_token->size; ++i) {
-        const char *key_str  = &json_data[key_token->start];
-        const char *value_str= &json_data[value_token->start];
-        u64         value_len= value_token->end - value_token->start;
-        if(compare_string_utf8(key_str, 4, "name")) {
-            key_token= value_token + 1;
-        } else if(compare_string_utf8(key_str, 4, "mesh")) {
-            key_token= value_token + 1;
-        } else if(compare_string_utf8(key_str, 8, "children")) {
-            jsmntok_t *out_token= &key_token[2];
-            for(u32 i= 0; i < value_token->size; ++i) { ++out_token; }
-            key_token= out_token;
-        } else if(compare_string_utf8(key_str, 6, "matrix")) {
-            jsmntok_t *out_token= &key_token[2];
-            for(u32 i= 0; i < value_token->size; ++i) { ++out_token; }
-            key_token= out_token;
-        } else if(compare_string_utf8(key_str, 8, "rotation")) {
-            jsmntok_t *out_token= &key_token[2];
-            for(u32 i= 0; i < value_token->size; ++i) { ++out_token; }
-            key_token= out_token;
-        }
-        value_token= key_token + 1;
+/* Decodes random elements of the layouts quantized and interleaved exports
+ * use, with the scalar kernels alone and with the SSE2 kernels in front. */
+static void
+glb_bench_accessors(u32 count) {
+    static const struct {
+        const char     *name;
+        accessor_layout layout;
+        accessor_target target;
+    } bench_list[]= {
+        {"  float3 interleaved to vec3",
+         {accessor_component_f32, 3, 1, false, 24},
+         accessor_target_vec3},
+        {"  snorm16x3 interleaved to vec3",
+         {accessor_component_s16, 3, 1, true, 8},
+         accessor_target_vec3},
+        {"  snorm8x3 interleaved to vec3",
+         {accessor_component_s8, 3, 1, true, 4},
+         accessor_target_vec3},
+        {"  unorm16x4 to vec3",
+         {accessor_component_u16, 4, 1, true, 0},
+         accessor_target_vec3},
+        {"  u8 indices to u16",
+         {accessor_component_u8, 1, 1, false, 0},
+         accessor_target_u16},
+        {"  u32 indices to u16",
+         {accessor_component_u32, 1, 1, false, 0},
+         accessor_target_u16},
+        {"  u16 indices to u8",
+         {accessor_component_u16, 1, 1, false, 0},
+         accessor_target_u8},
+    };
+    static const char *const isa_names[2]= {" scalar", " sse2"};
+    u64  *source= HeapAlloc(process_heap, 0, 24ull * count);
+    vec3 *out   = HeapAlloc(process_heap, 0, sizeof(vec3) * (u64)count);
+    if(source && out) {
+        u64 state= 0x9E3779B97F4A7C15ull;
+        for(u64 i= 0; i < 3ull * count; ++i)
+            source[i]= glb_bench_random(&state);
+        bench_print("accessor decode, ");
+        bench_print_u64(count);
+        bench_print(" elements\n");
+        for(u32 i= 0; i < sizeof(bench_list) / sizeof(bench_list[0]); ++i) {
+            for(u32 isa= 0; isa < 2; ++isa) {
+                accessor_decoder decoder;
+                if(!accessor_decoder_make(
+                       &bench_list[i].layout,
+                       bench_list[i].target,
+                       isa,
+                       &decoder))
+                    continue;
+                // Faults the output pages in before anything is timed
+                accessor_decode(&decoder, (const u8 *)source, count, out);
+                u64 decoded= 0;
+                f64 start  = bench_now();
+                f64 elapsed= 0.0;
+                do {
+                    accessor_decode(&decoder, (const u8 *)source, count, out);
+                    decoded+= count;
+                    elapsed= bench_now() - start;
+                } while(elapsed < GLB_BENCH_MIN_SECONDS);
+                bench_print(bench_list[i].name);
+                bench_print(isa_names[isa]);
+                bench_print(": ");
+                bench_print_f64((f64)decoded / elapsed / 1e6, 3);
+                bench_print(" Melements/s\n");
+            }
+        }
     }
-    return key_token;
+    if(source) HeapFree(process_heap, 0, source);
+    if(out) HeapFree(process_heap, 0, out);
 }
 
-typedef struct gltf_json_data {
-    u32               accessor_count;
-    u32               buffer_view_count;
-    gltf_buffer_view *buffer_view_list;
-    gltf_accessor    *accessor_list;
-    gltf_buffer       buffer;
-    gltf_mesh         mesh;
-} gltf_json_data;
+typedef f64 (*glb_strtod_fn)(const char *str, char **end);
 
+/* Converts the same numbers with both float parsers and with strtod, which
+ * is looked up in the UCRT at runtime since nothing links the CRT, and
+ * counts the doubles that differ from strtod. */
 static void
-gltf_parse_json(
-    gltf_json_data       *gltf_json,
-    const char           *json_data,
-    u64                   json_length,
-    const gltf_allocator *allocator) {
-    jsmn_parser parser;
-    jsmn_init(&parser);
-
-    int        count= jsmn_parse(&parser, json_data, json_length, null, 0);
-    jsmntok_t *tokens=
-        HeapAlloc(process_heap, HEAP_ZERO_MEMORY, sizeof(jsmntok_t) * count);
-    jsmn_init(&parser);
-    jsmn_parse(&parser, json_data, json_length, tokens, count);
-    assert(tokens[0].type == JSMN_OBJECT);
-    jsmntok_t *token= &tokens[1];
-
-    while(token != &tokens[count + 1]) {
-        assert(token->type == JSMN_STRING);
-        const char *key_str= &json_data[token->start];
-        if(compare_string_utf8(key_str, 9, "accessors")) {
-            jsmntok_t *value_token= &token[1];
-            jsmntok_t *out_token  = &token[2];
-            gltf_json->accessor_count= value_token->size;
-            gltf_json->accessor_list = allocator->alloc(
-                sizeof(gltf_accessor) * gltf_json->accessor_count);
-            for(int i= 0; i < value_token->size; ++i) {
-                gltf_accessor *accessor= &gltf_json->accessor_list[i];
-                out_token= gltf_parse_accessor(accessor, out_token, json_data);
-            }
-            token= out_token;
-        } else if(compare_string_utf8(key_str, 5, "asset")) {
-            token= token + 6;
-        } else if(compare_string_utf8(key_str, 11, "bufferViews")) {
-            jsmntok_t *value_token= &token[1];
-            jsmntok_t *out_token  = &token[2];
-            gltf_json->buffer_view_count= value_token->size;
-            gltf_json->buffer_view_list = allocator->alloc(
-                sizeof(gltf_buffer_view) * gltf_json->buffer_view_count);
-            for(int i= 0; i < value_token->size; ++i) {
-                gltf_buffer_view *buffer_view= &gltf_json->buffer_view_list[i];
-                out_token=
-                    gltf_parse_buffer_view(buffer_view, out_token, json_data);
-            }
-            token= out_token;
-        } else if(compare_string_utf8(key_str, 7, "buffers")) {
-            assert(value_token->size == 1);
-            jsmntok_t *value_token= &token[1];
-            jsmntok_t *out_token  = &token[2];
-            for(u32 i= 0; i < value_token->size; ++i) {
-                out_token=
-                    gltf_parse_buffer(&gltf_json->buffer, out_token, json_data);
-            }
-            token= out_token;
-        } else if(compare_string_utf8(key_str, 6, "images")) {
-            jsmntok_t *value_token= &token[1];
-            jsmntok_t *out_token  = &token[2];
-            for(u32 i= 0; i < value_token->size; ++i) {
-                out_token= gltf_parse_image(null, out_token, json_data);
-            }
-            token= out_token;
-        } else if(compare_string_utf8(key_str, 9, "materials")) {
-            jsmntok_t *value_token= &token[1];
-            jsmntok_t *out_token  = &token[2];
-            for(u32 i= 0; i < value_token->size; ++i) {
-                out_token= gltf_parse_material(null, out_token, json_data);
-            }
-            token= out_token;
-        } else if(compare_string_utf8(key_str, 6, "meshes")) {
-            jsmntok_t *value_token= &token[1];
-            jsmntok_t *out_token  = &token[2];
-            for(u32 i= 0; i < value_token->size; ++i) {
-                out_token= gltf_parse_mesh(
-                    &gltf_json->mesh,
-                    out_token,
-                    json_data,
-                    allocator);
-            }
-            token= out_token;
-        } else if(compare_string_utf8(key_str, 6, "scenes")) {
-            jsmntok_t *value_token= &token[1];
-            jsmntok_t *out_token  = &token[2];
-            for(u32 i= 0; i < value_token->size; ++i) {
-                out_token= gltf_parse_scene(null, out_token, json_data);
-            }
-            token= out_token;
-        } else if(compare_string_utf8(key_str, 5, "scene")) {
-            token+= 2;
-        } else if(compare_string_utf8(key_str, 5, "nodes")) {
-            jsmntok_t *value_token= &token[1];
-            jsmntok_t *out_token  = &token[2];
-            for(u32 i= 0; i < value_token->size; ++i) {
-                out_token= gltf_parse_node(null, out_token, json_data);
+glb_bench_floats(void) {
+    static const char *const parser_names[3]= {
+        "  convert_string_to_f64",
+        "  convert_string_to_f32",
+        "  ucrt strtod"};
+    u32  count      = 1u << 16;
+    u32 *offset_list= HeapAlloc(process_heap, 0, sizeof(u32) * (count + 1));
+    if(!offset_list) return;
+    u64   text_length;
+    char *text= glb_bench_float_text(offset_list, count, &text_length);
+    if(!text) {
+        HeapFree(process_heap, 0, offset_list);
+        return;
+    }
+    HMODULE       ucrt       = LoadLibrary(L"ucrtbase.dll");
+    glb_strtod_fn ucrt_strtod= null;
+    if(ucrt) ucrt_strtod= (glb_strtod_fn)GetProcAddress(ucrt, "strtod");
+    bench_print("float parsing, ");
+    bench_print_u64(count);
+    bench_print(" numbers, ");
+    bench_print_u64(text_length);
+    bench_print(" bytes\n");
+    volatile f64 sink= 0.0;
+    for(u32 parser= 0; parser < 3; ++parser) {
+        if(parser == 2 && !ucrt_strtod) {
+            bench_print(parser_names[parser]);
+            bench_print(": not available\n");
+            continue;
+        }
+        u64 bytes  = 0;
+        f64 start  = bench_now();
+        f64 elapsed= 0.0;
+        do {
+            f64 sum= 0.0;
+            for(u32 i= 0; i < count; ++i) {
+                const char *str   = &text[offset_list[i]];
+                u64         length= offset_list[i + 1] - offset_list[i] - 1;
+                switch(parser) {
+                case 0: sum+= convert_string_to_f64(str, length); break;
+                case 1: sum+= convert_string_to_f32(str, length); break;
+                case 2: sum+= ucrt_strtod(str, null); break;
+                }
             }
-            token= out_token;
-        } else {
-            ++token;
+            sink= sum;
+            bytes+= text_length;
+            elapsed= bench_now() - start;
+        } while(elapsed < GLB_BENCH_MIN_SECONDS);
+        bench_report_throughput(parser_names[parser], bytes, elapsed);
+    }
+    if(ucrt_strtod) {
+        u32 mismatch_count= 0;
+        for(u32 i= 0; i < count; ++i) {
+            const char *str   = &text[offset_list[i]];
+            u64         length= offset_list[i + 1] - offset_list[i] - 1;
+            if(convert_string_to_f64(str, length) != ucrt_strtod(str, null))
+                ++mismatch_count;
+        }
+        bench_print("  mismatches against strtod: ");
+        bench_print_u64(mismatch_count);
+        bench_print("\n");
+    }
+    if(ucrt) FreeLibrary(ucrt);
+    HeapFree(process_heap, 0, text);
+    HeapFree(process_heap, 0, offset_list);
+}
+
+static void
+glb_bench(glb_model *model_list, u32 model_count) {
+    bench_init();
+    job_system_init(~(0u));
+    for(u32 i= 0; i < model_count; ++i) {
+        HANDLE file_handle= CreateFile(
+            model_list[i].file_path,
+            FILE_READ_ATTRIBUTES | FILE_READ_DATA,
+            FILE_SHARE_READ,
+            NULL,
+            OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL,
+            NULL);
+        if(file_handle == INVALID_HANDLE_VALUE) continue;
+        glb_mapped_file mapped_file;
+        if(glb_map_file(file_handle, &mapped_file)) {
+            glb_bench_tokenizers(
+                "json chunk",
+                mapped_file.json_data,
+                mapped_file.json_length);
+            glb_bench_sections(
+                mapped_file.json_data,
+                mapped_file.json_length);
+            glb_bench_model_vertices(&mapped_file);
+            glb_unmap_file(&mapped_file);
         }
+        CloseHandle(file_handle);
     }
-    HeapFree(process_heap, 0, tokens);
+    for(u32 i= 0; i < 4; ++i) {
+        bool  indented= i & 1;
+        u64   size    = i < 2 ? 1ull << 20 : 64ull << 20;
+        u64   json_length;
+        char *json_data= glb_bench_synthetic_json(indented, size, &json_length);
+        if(!json_data) continue;
+        glb_bench_tokenizers(
+            indented ? "synthetic indented" : "synthetic compact",
+            json_data,
+            json_length);
+        glb_bench_sections(json_data, json_length);
+        HeapFree(process_heap, 0, json_data);
+    }
+    glb_bench_synthetic_vertices(1u << 20);
+    glb_bench_synthetic_vertices(16u << 20);
+    glb_bench_simplify(512);
+    glb_bench_normals(2048);
+    glb_bench_accessors(1u << 20);
+    glb_bench_floats();
+    job_system_shutdown();
 }
 
 static BOOL running= FALSE;
@@ -638,6 +4673,8 @@ PFN_vkGetPhysicalDeviceSurfacePresentModesKHR
                         vkGetPhysicalDeviceSurfacePresentModesKHR;
 PFN_vkGetDeviceProcAddr vkGetDeviceProcAddr;
 PFN_vkCreateDevice      vkCreateDevice;
+PFN_vkEnumerateDeviceExtensionProperties vkEnumerateDeviceExtensionProperties;
+PFN_vkGetPhysicalDeviceFeatures2KHR      vkGetPhysicalDeviceFeatures2KHR;
 
 VkInstance vk_instance;
 
@@ -708,6 +4745,14 @@ vulkan_create_instance() {
     vkCreateDevice= (PFN_vkCreateDevice)vkGetInstanceProcAddr(
         vk_instance,
         "vkCreateDevice");
+    vkEnumerateDeviceExtensionProperties=
+        (PFN_vkEnumerateDeviceExtensionProperties)vkGetInstanceProcAddr(
+            vk_instance,
+            "vkEnumerateDeviceExtensionProperties");
+    vkGetPhysicalDeviceFeatures2KHR=
+        (PFN_vkGetPhysicalDeviceFeatures2KHR)vkGetInstanceProcAddr(
+            vk_instance,
+            "vkGetPhysicalDeviceFeatures2KHR");
 }
 
 VkDebugUtilsMessengerEXT vk_dbg_messenger;
@@ -767,6 +4812,47 @@ vulkan_select_physical_device() {
     HeapFree(process_heap, 0, phy_dev_list);
 }
 
+bool vk_index_type_uint8;
+
+/* 8-bit indices need VK_EXT_index_type_uint8 and its feature. */
+static void
+vulkan_query_index_type_uint8() {
+    vk_index_type_uint8= false;
+    if(!vk_physical_device) return;
+    DWORD extension_count= 0;
+    vkEnumerateDeviceExtensionProperties(
+        vk_physical_device,
+        NULL,
+        &extension_count,
+        NULL);
+    VkExtensionProperties *extension_list= (VkExtensionProperties *)HeapAlloc(
+        process_heap,
+        HEAP_ZERO_MEMORY,
+        sizeof(VkExtensionProperties) * extension_count);
+    if(!extension_list) return;
+    vkEnumerateDeviceExtensionProperties(
+        vk_physical_device,
+        NULL,
+        &extension_count,
+        extension_list);
+    bool supported= false;
+    for(DWORD i= 0; !supported && i < extension_count; ++i) {
+        supported= lstrcmpA(
+                       extension_list[i].extensionName,
+                       VK_EXT_INDEX_TYPE_UINT8_EXTENSION_NAME) == 0;
+    }
+    HeapFree(process_heap, 0, extension_list);
+    if(!supported) return;
+    VkPhysicalDeviceIndexTypeUint8FeaturesEXT uint8_features= {0};
+    uint8_features.sType=
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_INDEX_TYPE_UINT8_FEATURES_EXT;
+    VkPhysicalDeviceFeatures2KHR features= {0};
+    features.sType= VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+    features.pNext= &uint8_features;
+    vkGetPhysicalDeviceFeatures2KHR(vk_physical_device, &features);
+    vk_index_type_uint8= uint8_features.indexTypeUint8 == VK_TRUE;
+}
+
 VkSurfaceKHR vk_surface;
 
 static void
@@ -854,15 +4940,20 @@ vulkan_create_device() {
     VkDeviceQueueCreateInfo queue_create_infos[3]= {0};
     for(u32 i= 0; i < 3; ++i)
         queue_create_infos[i].sType= VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-    const char *device_extensions[5]= {
+    const char *device_extensions[6]= {
         "VK_KHR_swapchain",
         "VK_KHR_maintenance1",
         "VK_KHR_create_renderpass2",
         "VK_KHR_depth_stencil_resolve",
-        "VK_KHR_dynamic_rendering"};
+        "VK_KHR_dynamic_rendering",
+        VK_EXT_INDEX_TYPE_UINT8_EXTENSION_NAME};
+    VkPhysicalDeviceIndexTypeUint8FeaturesEXT uint8_feature= {
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_INDEX_TYPE_UINT8_FEATURES_EXT,
+        NULL,
+        VK_TRUE};
     VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeature= {
         VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR,
-        NULL,
+        vk_index_type_uint8 ? &uint8_feature : NULL,
         VK_TRUE};
     VkPhysicalDeviceFeatures2KHR features= {0};
     features.sType= VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
@@ -870,7 +4961,7 @@ vulkan_create_device() {
     VkDeviceCreateInfo create_info     = {0};
     create_info.sType                  = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
     create_info.pNext                  = &features;
-    create_info.enabledExtensionCount  = 5;
+    create_info.enabledExtensionCount  = vk_index_type_uint8 ? 6 : 5;
     create_info.ppEnabledExtensionNames= device_extensions;
     create_info.pQueueCreateInfos      = queue_create_infos;
     VkDeviceQueueCreateInfo *queue_create_info_it= queue_create_infos;
@@ -1303,6 +5394,16 @@ vulkan_create_pipeline() {
             &vk_pipeline.pipeline_layout);
     }
     {
+        // Selects the octahedral normal decode in the vertex shader
+        VkBool32 octahedral_normals=
+            load_options.vertex_format != vertex_format_float;
+        VkSpecializationMapEntry specialization_entries[1]= {
+            {0, 0, sizeof(VkBool32)}};
+        VkSpecializationInfo vertex_specialization= {
+            1,
+            specialization_entries,
+            sizeof(VkBool32),
+            &octahedral_normals};
         VkPipelineShaderStageCreateInfo shader_stage_infos[2]= {
             {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
              NULL,
@@ -1310,7 +5411,7 @@ vulkan_create_pipeline() {
              VK_SHADER_STAGE_VERTEX_BIT,
              vk_pipeline.vertex_shader,
              "vert_main",
-             NULL},
+             &vertex_specialization},
             {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
              NULL,
              0,
@@ -1320,11 +5421,22 @@ vulkan_create_pipeline() {
              NULL},
         };
         VkVertexInputBindingDescription binding_descs[1]= {
-            {0, sizeof(float) * 8, VK_VERTEX_INPUT_RATE_VERTEX}};
+            {0, glb_vertex_size(), VK_VERTEX_INPUT_RATE_VERTEX}};
         VkVertexInputAttributeDescription attribute_descs[2]= {
             {0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0},
             {1, 0, VK_FORMAT_R32G32B32_SFLOAT, sizeof(float) * 4},
         };
+        // Quantized positions are read as four components, the fourth is
+        // padding or overlaps the normal and is ignored
+        if(load_options.vertex_format == vertex_format_oct16) {
+            attribute_descs[0].format= VK_FORMAT_R16G16B16A16_SNORM;
+            attribute_descs[1].format= VK_FORMAT_R16G16_SNORM;
+            attribute_descs[1].offset= FIELD_OFFSET(vertex_oct16, nrm);
+        } else if(load_options.vertex_format == vertex_format_oct8) {
+            attribute_descs[0].format= VK_FORMAT_R16G16B16A16_SNORM;
+            attribute_descs[1].format= VK_FORMAT_R8G8_SNORM;
+            attribute_descs[1].offset= FIELD_OFFSET(vertex_oct8, nrm);
+        }
         VkPipelineVertexInputStateCreateInfo vertex_input_state= {
             VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
             NULL,
@@ -1757,20 +5869,29 @@ vulkan_create_staging_buffer(
     VkMemoryRequirements mem_reqs= {0};
     vkGetBufferMemoryRequirements(vk_device, *staging_buffer, &mem_reqs);
 
-    u32 mem_type_mask= mem_reqs.memoryTypeBits;
-    u32 mem_type_idx = ~(0u);
-    for(u32 i= 0; i < 32; ++i) {
-        if(mem_type_mask & 1 << i == 0) continue;
-        VkMemoryType *type= &mem_props.memoryTypes[i];
-        VkMemoryHeap *heap= &mem_props.memoryHeaps[type->heapIndex];
-        if((type->propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) == 0 &&
-           (type->propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) &&
-           // On certain gpus, a smaller heap is present to allow
-           // fast CPU to GPU updates that we don't want to use for
-           // Vertex/Index Buffer memory
-           heap->size > 256 * 1024 * 1024) {
-            mem_type_idx= i;
-            break;
+    // Normal generation, optimization, levels of detail, clusters and the
+    // cache read the converted models back out of staging memory, which is
+    // only fast from a type the CPU caches, uncached types are the fallback
+    u32                   mem_type_mask= mem_reqs.memoryTypeBits;
+    u32                   mem_type_idx = ~(0u);
+    VkMemoryPropertyFlags readback     = VK_MEMORY_PROPERTY_HOST_CACHED_BIT |
+                                         VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    for(u32 pass= 0; mem_type_idx == ~(0u) && pass < 2; ++pass) {
+        for(u32 i= 0; i < 32; ++i) {
+            if(mem_type_mask & 1 << i == 0) continue;
+            VkMemoryType *type= &mem_props.memoryTypes[i];
+            VkMemoryHeap *heap= &mem_props.memoryHeaps[type->heapIndex];
+            if((type->propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) ==
+                   0 &&
+               (type->propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) &&
+               (pass || (type->propertyFlags & readback) == readback) &&
+               // On certain gpus, a smaller heap is present to allow
+               // fast CPU to GPU updates that we don't want to use for
+               // Vertex/Index Buffer memory
+               heap->size > 256 * 1024 * 1024) {
+                mem_type_idx= i;
+                break;
+            }
         }
     }
     assert(mem_type_idx != ~(0u));
@@ -1829,15 +5950,59 @@ vulkan_copy_mesh_data_to_gpu(
     vkQueueWaitIdle(vk_gfx_queue);
 }
 
-typedef struct mesh_primitive_t {
-    u32 vertex_count;
-    u32 vertex_offset;
-    u32 index_count;
-    u32 index_offset;
-} mesh_primitive_t;
+// Screen-space error a level of detail may show, in pixels
+#define GLB_LOD_PIXEL_ERROR 1.F
 
-static void
-vulkan_render_frame(u32 primitive_count, mesh_primitive_t *primitive_list) {
+/* Picks the coarsest level whose error, scaled by the longest axis of
+ * `primitive_world` and seen at the point of the bounds closest to the eye,
+ * covers at most GLB_LOD_PIXEL_ERROR pixels, with `pixels_per_unit` pixels
+ * for a world unit at depth 1. Level 0 is the full range, which primitives
+ * without levels and bounds around the eye always get. */
+static u32
+mesh_primitive_select_lod(
+    const mesh_primitive_t *primitive,
+    const mat4x4           *primitive_world,
+    const mat4x4           *clip_from_model,
+    f32                     pixels_per_unit) {
+    if(!primitive->lod_count) return 0;
+    f32 scale_squared= 0.F;
+    for(u32 c= 0; c < 3; ++c) {
+        const vec4 *axis          = &primitive_world->columns[c];
+        f32         length_squared=
+            axis->x * axis->x + axis->y * axis->y + axis->z * axis->z;
+        if(length_squared > scale_squared) scale_squared= length_squared;
+    }
+    f32 scale= sqrt_f32(scale_squared);
+    // Clip w is the depth in front of the eye
+    const vec4 *center= &primitive->bounds;
+    f32         depth = clip_from_model->columns[3].w;
+    for(u32 c= 0; c < 3; ++c)
+        depth+= clip_from_model->columns[c].w * center->data[c];
+    depth-= center->w * scale;
+    if(depth <= 0.F) return 0;
+    u32 level= 0;
+    while(level < primitive->lod_count &&
+          primitive->lod_list[level].error * scale * pixels_per_unit <=
+              GLB_LOD_PIXEL_ERROR * depth)
+        ++level;
+    return level;
+}
+
+/* What a frame drew. */
+typedef struct glb_frame_stats {
+    u64 triangle_count;
+    u32 visible_clusters;
+} glb_frame_stats;
+
+/* Draws every primitive at the level of detail its screen-space error
+ * allows, and only the visible clusters of full ranges that have them when
+ * `cluster_list` is set. */
+static glb_frame_stats
+vulkan_render_frame(
+    u32                      primitive_count,
+    mesh_primitive_t        *primitive_list,
+    const mesh_cluster_list *cluster_list,
+    u32                     *cluster_ranges) {
     vkResetCommandPool(vk_device, vk_gfx_cmd_pool, 0);
     DWORD index= 0;
     vkAcquireNextImageKHR(
@@ -1896,11 +6061,6 @@ vulkan_render_frame(u32 primitive_count, mesh_primitive_t *primitive_list) {
         vk_pipeline.pipeline);
     VkDeviceSize offset= 0;
     vkCmdBindVertexBuffers(vk_gfx_cmd_buffer, 0, 1, &vk_vertex_buffer, &offset);
-    vkCmdBindIndexBuffer(
-        vk_gfx_cmd_buffer,
-        vk_index_buffer,
-        offset,
-        VK_INDEX_TYPE_UINT16);
     VkViewport viewport= {0, 720, 1280, -720, 0, 1};
     vkCmdSetViewport(vk_gfx_cmd_buffer, 0, 1, &viewport);
     VkRect2D scissor= {0, 0, 1280, 720};
@@ -1916,13 +6076,6 @@ vulkan_render_frame(u32 primitive_count, mesh_primitive_t *primitive_list) {
     mat4x4 world= {0};
     mat4x4_make_rot_matrix(M_TO_RAD(-90), M_TO_RAD(0), M_TO_RAD(0), &world);
     vec4_set(world.columns[3], 0.F, 0.F, -3.F, 1.F);
-    vkCmdPushConstants(
-        vk_gfx_cmd_buffer,
-        vk_pipeline.pipeline_layout,
-        VK_SHADER_STAGE_VERTEX_BIT,
-        0,
-        sizeof(mat4x4),
-        &world);
     vkCmdPushConstants(
         vk_gfx_cmd_buffer,
         vk_pipeline.pipeline_layout,
@@ -1930,8 +6083,92 @@ vulkan_render_frame(u32 primitive_count, mesh_primitive_t *primitive_list) {
         sizeof(mat4x4),
         sizeof(mat4x4),
         &view_proj);
+    // Pixels a world unit at depth 1 covers on screen
+    f32 pixels_per_unit= proj.data[5] * (f32)scissor.extent.height * 0.5F;
+    // Draws are ordered by index width, so the index buffer is bound once
+    // per width, its offset stays 0 and firstIndex picks the range
+    u32             bound_index_size= 0;
+    glb_frame_stats stats           = {0};
     for(u32 i= 0; i < primitive_count; ++i) {
         mesh_primitive_t *primitive= &primitive_list[i];
+        if(primitive->index_size != bound_index_size) {
+            VkIndexType index_type= VK_INDEX_TYPE_UINT32;
+            if(primitive->index_size == 1) index_type= VK_INDEX_TYPE_UINT8_EXT;
+            if(primitive->index_size == 2) index_type= VK_INDEX_TYPE_UINT16;
+            vkCmdBindIndexBuffer(
+                vk_gfx_cmd_buffer,
+                vk_index_buffer,
+                offset,
+                index_type);
+            bound_index_size= primitive->index_size;
+        }
+        // Folds the dequantization of the primitive into its world matrix,
+        // world * translate(pos_offset) * scale(pos_scale)
+        mat4x4 primitive_world= world;
+        for(u32 c= 0; c < 3; ++c) {
+            f32 offset= primitive->pos_offset.data[c];
+            for(u32 r= 0; r < 4; ++r) {
+                primitive_world.columns[3].data[r]+=
+                    world.columns[c].data[r] * offset;
+                primitive_world.columns[c].data[r]*=
+                    primitive->pos_scale.data[c];
+            }
+        }
+        vkCmdPushConstants(
+            vk_gfx_cmd_buffer,
+            vk_pipeline.pipeline_layout,
+            VK_SHADER_STAGE_VERTEX_BIT,
+            0,
+            sizeof(mat4x4),
+            &primitive_world);
+        bool   clustered= cluster_list && primitive->cluster_count;
+        mat4x4 clip_from_model;
+        if(primitive->lod_count || clustered) {
+            // mat4x4_mul leaves the product transposed
+            mat4x4_mul(&view_proj, &primitive_world, &clip_from_model);
+            mat4x4_transpose(&clip_from_model, &clip_from_model);
+        }
+        u32 level= mesh_primitive_select_lod(
+            primitive,
+            &primitive_world,
+            &clip_from_model,
+            pixels_per_unit);
+        if(level) {
+            const mesh_lod_t *lod= &primitive->lod_list[level - 1];
+            vkCmdDrawIndexed(
+                vk_gfx_cmd_buffer,
+                lod->index_count,
+                1,
+                primitive->index_offset + lod->first_index,
+                primitive->vertex_offset,
+                0);
+            stats.triangle_count+= lod->index_count / 3;
+            continue;
+        }
+        if(clustered) {
+            mesh_cull_view cull_view;
+            mesh_cull_view_make(&clip_from_model, &cull_view);
+            u32 visible_count;
+            u32 range_count= mesh_cull_clusters(
+                cluster_list,
+                primitive->first_cluster,
+                primitive->cluster_count,
+                &cull_view,
+                cluster_ranges,
+                &visible_count);
+            stats.visible_clusters+= visible_count;
+            for(u32 r= 0; r < range_count; ++r) {
+                vkCmdDrawIndexed(
+                    vk_gfx_cmd_buffer,
+                    cluster_ranges[2 * r + 1],
+                    1,
+                    primitive->index_offset + cluster_ranges[2 * r],
+                    primitive->vertex_offset,
+                    0);
+                stats.triangle_count+= cluster_ranges[2 * r + 1] / 3;
+            }
+            continue;
+        }
         vkCmdDrawIndexed(
             vk_gfx_cmd_buffer,
             primitive->index_count,
@@ -1939,6 +6176,7 @@ vulkan_render_frame(u32 primitive_count, mesh_primitive_t *primitive_list) {
             primitive->index_offset,
             primitive->vertex_offset,
             0);
+        stats.triangle_count+= primitive->index_count / 3;
     }
     /*------------------------------------------------------------------------*/
     vkCmdEndRenderingKHR(vk_gfx_cmd_buffer);
@@ -1986,6 +6224,219 @@ vulkan_render_frame(u32 primitive_count, mesh_primitive_t *primitive_list) {
     present_info.pSwapchains     = &vk_swapchain;
     present_info.pImageIndices   = &index;
     vkQueuePresentKHR(vk_wsi_queue, &present_info);
+    return stats;
+}
+
+/* Orders the draws of all models by index width, so a frame binds the
+ * index buffer once per width, and drops the ones with nothing to draw.
+ * The order within a width is kept. Returns the remaining count. */
+static u32
+mesh_primitive_sort_draws(mesh_primitive_t *primitive_list, u32 count) {
+    mesh_primitive_t *sorted_list=
+        HeapAlloc(process_heap, 0, sizeof(mesh_primitive_t) * count);
+    if(!sorted_list) return count;
+    u32 sorted_count= 0;
+    for(u32 index_size= 1; index_size <= 4; index_size*= 2) {
+        for(u32 i= 0; i < count; ++i) {
+            if(primitive_list[i].index_size == index_size &&
+               primitive_list[i].index_count)
+                sorted_list[sorted_count++]= primitive_list[i];
+        }
+    }
+    for(u32 i= 0; i < sorted_count; ++i) primitive_list[i]= sorted_list[i];
+    HeapFree(process_heap, 0, sorted_list);
+    return sorted_count;
+}
+
+/* Prints the vertex counts before and after welding for every primitive
+ * this load welded. */
+static void
+glb_report_weld_stats(const glb_model *model_list, u32 model_count) {
+    u64 vertex_counts[2]= {0};
+    bench_init();
+    for(u32 m= 0; m < model_count; ++m) {
+        const glb_model *model= &model_list[m];
+        if(!model->loaded || !model->unwelded_vertex_counts) continue;
+        for(u32 i= 0; i < model->primitive_count; ++i) {
+            u32 unwelded_count= model->unwelded_vertex_counts[i];
+            u32 welded_count  = model->primitive_list[i].vertex_count;
+            bench_print("weld, model ");
+            bench_print_u64(m);
+            bench_print(" primitive ");
+            bench_print_u64(i);
+            bench_print(": ");
+            bench_print_u64(unwelded_count);
+            bench_print(" -> ");
+            bench_print_u64(welded_count);
+            bench_print(" vertices\n");
+            vertex_counts[0]+= unwelded_count;
+            vertex_counts[1]+= welded_count;
+        }
+    }
+    if(!vertex_counts[1]) return;
+    bench_print("weld, total: ");
+    bench_print_u64(vertex_counts[0]);
+    bench_print(" -> ");
+    bench_print_u64(vertex_counts[1]);
+    bench_print(" vertices, ");
+    bench_print_f64((f64)vertex_counts[0] / (f64)vertex_counts[1], 2);
+    bench_print("x smaller\n");
+}
+
+/* Prints the vertex cache statistics of the models optimized by this load,
+ * models that came from the cache were optimized by an earlier one. */
+static void
+glb_report_cache_stats(const glb_model *model_list, u32 model_count) {
+    mesh_cache_stats stats[2]= {0};
+    for(u32 m= 0; m < model_count; ++m) {
+        if(!model_list[m].loaded) continue;
+        for(u32 i= 0; i < 2; ++i) {
+            const mesh_cache_stats *model_stats= &model_list[m].cache_stats[i];
+            stats[i].triangle_count+= model_stats->triangle_count;
+            stats[i].vertex_count+= model_stats->vertex_count;
+            stats[i].transform_count+= model_stats->transform_count;
+        }
+    }
+    if(!stats[0].triangle_count) return;
+    bench_init();
+    bench_print("vertex cache, ");
+    bench_print_u64(stats[0].triangle_count);
+    bench_print(" triangles: ACMR ");
+    bench_print_f64(mesh_cache_acmr(&stats[0]), 3);
+    bench_print(" -> ");
+    bench_print_f64(mesh_cache_acmr(&stats[1]), 3);
+    bench_print(", ATVR ");
+    bench_print_f64(mesh_cache_atvr(&stats[0]), 3);
+    bench_print(" -> ");
+    bench_print_f64(mesh_cache_atvr(&stats[1]), 3);
+    bench_print("\n");
+}
+
+/* Prints the triangles of every level of detail this load generated and the
+ * simplification throughput, the time being the sum over models. Models
+ * that came from the cache were simplified by an earlier load. */
+static void
+glb_report_lod_stats(const glb_model *model_list, u32 model_count) {
+    u64 triangle_counts[MESH_LOD_COUNT + 1]= {0};
+    f64 seconds                            = 0.0;
+    for(u32 m= 0; m < model_count; ++m) {
+        const glb_model *model= &model_list[m];
+        if(!model->loaded) continue;
+        for(u32 level= 0; level <= MESH_LOD_COUNT; ++level)
+            triangle_counts[level]+= model->lod_triangle_counts[level];
+        seconds+= model->lod_seconds;
+    }
+    if(!triangle_counts[0]) return;
+    bench_init();
+    bench_print("lods, triangles per level:");
+    for(u32 level= 0; level <= MESH_LOD_COUNT; ++level) {
+        bench_print(" ");
+        bench_print_u64(triangle_counts[level]);
+    }
+    bench_print("\nlods, ");
+    bench_print_u64(triangle_counts[0]);
+    bench_print(" triangles simplified in ");
+    bench_print_f64(seconds * 1e3, 2);
+    bench_print(" ms");
+    if(seconds > 0.0) {
+        bench_print(", ");
+        bench_print_f64((f64)triangle_counts[0] / seconds / 1e6, 3);
+        bench_print(" Mtriangles/s");
+    }
+    bench_print("\n");
+}
+
+/* Prints the vertices this load generated normals for and the throughput,
+ * nothing when every primitive came with its own or from the cache. */
+static void
+glb_report_normal_stats(const glb_model *model_list, u32 model_count) {
+    u64 vertex_count= 0, triangle_count= 0;
+    f64 seconds     = 0.0;
+    for(u32 m= 0; m < model_count; ++m) {
+        const glb_model *model= &model_list[m];
+        if(!model->loaded) continue;
+        vertex_count+= model->normal_vertex_count;
+        triangle_count+= model->normal_triangle_count;
+        seconds+= model->normal_seconds;
+    }
+    if(!vertex_count) return;
+    bench_init();
+    bench_print("normals, ");
+    bench_print_u64(vertex_count);
+    bench_print(" vertices generated from ");
+    bench_print_u64(triangle_count);
+    bench_print(" triangles in ");
+    bench_print_f64(seconds * 1e3, 2);
+    bench_print(" ms");
+    // Points and lines add vertices but no triangles
+    if(seconds > 0.0 && triangle_count) {
+        bench_print(", ");
+        bench_print_f64((f64)triangle_count / seconds / 1e6, 3);
+        bench_print(" Mtriangles/s");
+    }
+    bench_print("\n");
+}
+
+/* Moves the clusters of every model into one list and points the draws at
+ * their range of it, models drop theirs. Returns the memory of the list,
+ * null without clusters, and allocates the range buffer for the largest
+ * primitive. */
+static void *
+glb_merge_clusters(
+    glb_model         *model_list,
+    u32                model_count,
+    mesh_primitive_t  *mesh_prim_list,
+    mesh_cluster_list *cluster_list,
+    u32              **cluster_ranges) {
+    u32 cluster_count= 0, max_cluster_count= 0;
+    u64 triangle_count= 0;
+    for(u32 m= 0; m < model_count; ++m)
+        if(model_list[m].loaded) cluster_count+= model_list[m].clusters.count;
+    void *cluster_memory= null;
+    if(cluster_count) {
+        cluster_memory=
+            HeapAlloc(process_heap, 0, mesh_cluster_list_size(cluster_count));
+    }
+    if(cluster_memory)
+        mesh_cluster_list_init(cluster_list, cluster_memory, cluster_count);
+    u32 first_cluster= 0;
+    for(u32 m= 0; m < model_count; ++m) {
+        glb_model *model= &model_list[m];
+        if(cluster_memory && model->loaded && model->clusters.count) {
+            mesh_cluster_list_copy(
+                cluster_list,
+                first_cluster,
+                &model->clusters,
+                0,
+                model->clusters.count);
+            for(u32 i= 0; i < model->primitive_count; ++i) {
+                mesh_primitive_t *primitive=
+                    &mesh_prim_list[model->first_primitive + i];
+                primitive->first_cluster= first_cluster;
+                primitive->cluster_count= model->cluster_counts[i];
+                first_cluster+= primitive->cluster_count;
+                if(primitive->cluster_count > max_cluster_count)
+                    max_cluster_count= primitive->cluster_count;
+                if(primitive->cluster_count)
+                    triangle_count+= primitive->index_count / 3;
+            }
+        }
+        glb_model_free_clusters(model);
+    }
+    if(!cluster_memory) return null;
+    *cluster_ranges=
+        HeapAlloc(process_heap, 0, 2 * sizeof(u32) * max_cluster_count);
+    if(!*cluster_ranges) {
+        HeapFree(process_heap, 0, cluster_memory);
+        return null;
+    }
+    bench_init();
+    bench_print("clusters, ");
+    bench_print_u64(cluster_count);
+    bench_print(" for ");
+    bench_print_u64(triangle_count);
+    bench_print(" triangles\n");
+    return cluster_memory;
 }
 
 int _fltused= 0;
@@ -1995,88 +6446,88 @@ main() {
     int     argc;
     LPWSTR *argv;
     argv= CommandLineToArgvW(GetCommandLineW(), &argc);
-    if(argc < 2) ExitProcess(-1);
     process_heap= GetProcessHeap();
-    /*========================================================================*/
-    /* Open GLB File                  */
-    /*========================================================================*/
-    HANDLE file_handle= CreateFile(
-        argv[1],
-        FILE_READ_ATTRIBUTES | FILE_READ_DATA,
-        FILE_SHARE_READ,
-        NULL,
-        OPEN_EXISTING,
-        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED,
-        NULL);
-    if(file_handle == INVALID_HANDLE_VALUE) {
-        DWORD err= GetLastError();
-        ExitProcess(-1);
-    }
-    DWORD      bytes_read= 0u;
-    glb_header header    = {0};
-    OVERLAPPED overlapped= {0};
-    overlapped.OffsetHigh= 0u;
-    overlapped.Offset    = 0u;
-    ReadFile(
-        file_handle,
-        &header,
-        sizeof(glb_header),
-        &bytes_read,
-        &overlapped);
-    if(header.magic != 0x46546C67u) {
-        CloseHandle(file_handle);
-        ExitProcess(-1);
-    }
-    DWORD json_chunk_offset    = sizeof(glb_header);
-    overlapped.Offset          = json_chunk_offset;
-    glb_chunk_header json_chunk= {0};
-    ReadFile(
-        file_handle,
-        &json_chunk,
-        sizeof(glb_chunk_header),
-        &bytes_read,
-        &overlapped);
-    if(json_chunk.type != glb_chunk_json) {
-        CloseHandle(file_handle);
-        ExitProcess(-1);
-    }
-    DWORD bin_chunk_offset=
-        json_chunk_offset + sizeof(glb_chunk_header) + json_chunk.length;
-    overlapped.Offset         = bin_chunk_offset;
-    glb_chunk_header bin_chunk= {0};
-    ReadFile(
-        file_handle,
-        &bin_chunk,
-        sizeof(glb_chunk_header),
-        &bytes_read,
-        &overlapped);
-    if(bin_chunk.type != glb_chunk_bin) {
-        CloseHandle(file_handle);
-        ExitProcess(-1);
-    }
-    overlapped.Offset= json_chunk_offset + sizeof(glb_chunk_header);
-    void *json_chunk_data=
-        HeapAlloc(process_heap, HEAP_ZERO_MEMORY, json_chunk.length);
-    ReadFile(
-        file_handle,
-        json_chunk_data,
-        json_chunk.length,
-        &bytes_read,
-        &overlapped);
-    gltf_json_data gltf_json= {0};
-    gltf_parse_json(
-        &gltf_json,
-        json_chunk_data,
-        json_chunk.length,
-        &g_allocator);
-    HeapFree(process_heap, 0, json_chunk_data);
+#ifndef NDEBUG
+    if(!gltf_check_key_tables()) ExitProcess(-1);
+#endif
+    glb_model *model_list = NULL;
+    u32        model_count= 0;
+    bool       bench_mode = false;
+    load_options.tokenizer= gltf_tokenizer_scan_sse2;
+    if(json_scan_best_isa() == json_scan_isa_avx2)
+        load_options.tokenizer= gltf_tokenizer_scan_avx2;
+    load_options.vertex_isa= vertex_convert_best_isa();
+    for(int i= 1; i < argc; ++i) {
+        if(lstrcmpW(argv[i], L"--bench") == 0)
+            bench_mode= true;
+        else if(lstrcmpW(argv[i], L"--jsmn") == 0)
+            load_options.tokenizer= gltf_tokenizer_jsmn;
+        else if(lstrcmpW(argv[i], L"--lazy") == 0)
+            load_options.json_sections= GLTF_JSON_SECTIONS_GEOMETRY;
+        else if(lstrcmpW(argv[i], L"--mmap") == 0)
+            load_options.load_mode= glb_load_mode_mapped;
+        else if(lstrcmpW(argv[i], L"--direct") == 0)
+            load_options.load_mode= glb_load_mode_direct;
+        else if(lstrcmpW(argv[i], L"--stream") == 0)
+            load_options.load_mode= glb_load_mode_stream;
+        else if(lstrcmpW(argv[i], L"--cache") == 0)
+            load_options.use_cache= true;
+        else if(lstrcmpW(argv[i], L"--heap") == 0)
+            load_options.use_arena= false;
+        else if(lstrcmpW(argv[i], L"--compact") == 0)
+            load_options.vertex_format= vertex_format_oct16;
+        else if(lstrcmpW(argv[i], L"--compact8") == 0)
+            load_options.vertex_format= vertex_format_oct8;
+        else if(lstrcmpW(argv[i], L"--optimize") == 0)
+            load_options.optimize_meshes= true;
+        else if(lstrcmpW(argv[i], L"--weld") == 0)
+            load_options.weld_vertices= true;
+        else if(lstrcmpW(argv[i], L"--clusters") == 0)
+            load_options.cluster_culling= true;
+        else if(lstrcmpW(argv[i], L"--lods") == 0)
+            load_options.generate_lods= true;
+        else if(!glb_collect_models(argv[i], &model_list, &model_count))
+            ExitProcess(-1);
+    }
+    if(bench_mode) {
+        glb_bench(model_list, model_count);
+        ExitProcess(0);
+    }
+    if(!model_count) ExitProcess(-1);
+    job_system_init(~(0u));
     /*========================================================================*/
     /* Vulkan Initialization                                                  */
     /*========================================================================*/
+    // The index widths of the load depend on the device, so it is picked
+    // before any model is opened
     vulkan_load_library();
     vulkan_create_instance();
     vulkan_create_debug_messenger();
     vulkan_select_physical_device();
+    vulkan_query_index_type_uint8();
+    load_options.index_uint8= vk_index_type_uint8;
+    /*========================================================================*/
+    /* Open GLB Files                                                         */
+    /*========================================================================*/
+    // Welding generates normals while the models open and times them, as
+    // conversion does for normals and simplification later on
+    bench_init();
+    job_dispatch(glb_model_open_job, model_list, model_count);
+    if(load_options.weld_vertices)
+        glb_report_weld_stats(model_list, model_count);
+    u32 mesh_prim_count= 0;
+    u64 vertex_count= 0, index_buffer_size= 0;
+    for(u32 i= 0; i < model_count; ++i) {
+        glb_model *model= &model_list[i];
+        if(!model->loaded) continue;
+        model->first_primitive= mesh_prim_count;
+        model->first_vertex   = vertex_count;
+        model->index_offset   = index_buffer_size;
+        mesh_prim_count+= model->primitive_count;
+        vertex_count+= model->vertex_count;
+        index_buffer_size+= model->index_size;
+    }
+    if(!mesh_prim_count) ExitProcess(-1);
     vulkan_create_device();
     vulkan_create_command_context();
     win32_create_window();
@@ -2089,43 +6540,23 @@ main() {
     /*------------------------------------------------------------------------*/
     /* Buffer Creation                                                        */
     /*------------------------------------------------------------------------*/
-    u32               mesh_prim_count= gltf_json.mesh.primitive_count;
-    mesh_primitive_t *mesh_prim_list = HeapAlloc(
+    mesh_primitive_t *mesh_prim_list= HeapAlloc(
         process_heap,
         HEAP_ZERO_MEMORY,
         sizeof(mesh_primitive_t) * mesh_prim_count);
-    u64 vertex_buffer_size= 0, index_buffer_size= 0;
-    u32 vertex_count= 0, vertex_offset= 0, index_count= 0, index_offset= 0;
-    for(u32 i= 0; i < gltf_json.mesh.primitive_count; ++i) {
-        gltf_mesh_primitive *gltf_primitive= &gltf_json.mesh.primitive_list[i];
-        /*--------------------------------------------------------------------*/
-        /* POSITION Attribute                                                 */
-        /*--------------------------------------------------------------------*/
-        gltf_accessor *pos_accessor=
-            &gltf_json.accessor_list[gltf_primitive->pos_accessor];
-        /*--------------------------------------------------------------------*/
-        /* NORMAL Attribute                                                   */
-        /*--------------------------------------------------------------------*/
-        gltf_accessor *nrm_accessor=
-            &gltf_json.accessor_list[gltf_primitive->nrm_accessor];
-        vertex_buffer_size+= sizeof(vertex) * pos_accessor->count;
-        /*--------------------------------------------------------------------*/
-        /* INDEX                                                              */
-        /*--------------------------------------------------------------------*/
-        gltf_accessor *idx_accessor=
-            &gltf_json.accessor_list[gltf_primitive->idx_accessor];
-        index_buffer_size+= sizeof(u16) * idx_accessor->count;
-        /*--------------------------------------------------------------------*/
-        /* Fill the Mesh Primitive Struct                                     */
-        /*--------------------------------------------------------------------*/
-        mesh_primitive_t *primitive= &mesh_prim_list[i];
-        primitive->vertex_count    = pos_accessor->count;
-        primitive->index_count     = idx_accessor->count;
-        primitive->vertex_offset   = vertex_offset;
-        primitive->index_offset    = index_offset;
-        /*--------------------------------------------------------------------*/
-        vertex_offset= pos_accessor->count;
-        index_offset = idx_accessor->count;
+    u64 vertex_buffer_size= glb_vertex_size() * vertex_count;
+    for(u32 m= 0; m < model_count; ++m) {
+        glb_model *model= &model_list[m];
+        if(!model->loaded) continue;
+        // Model primitives are relative to the model's own buffer range
+        for(u32 i= 0; i < model->primitive_count; ++i) {
+            mesh_primitive_t *primitive=
+                &mesh_prim_list[model->first_primitive + i];
+            *primitive= model->primitive_list[i];
+            primitive->vertex_offset+= (u32)model->first_vertex;
+            primitive->index_offset+=
+                (u32)(model->index_offset / primitive->index_size);
+        }
     }
     vulkan_create_vertex_buffer(vertex_buffer_size);
     vulkan_create_index_buffer(index_buffer_size);
@@ -2140,86 +6571,50 @@ main() {
     /*========================================================================*/
     /* GLTF Binary Data                                                       */
     /*========================================================================*/
-    overlapped.Offset= bin_chunk_offset + sizeof(glb_chunk_header);
-    void *bin_chunk_data=
-        HeapAlloc(process_heap, HEAP_ZERO_MEMORY, bin_chunk.length);
-    ReadFile(
-        file_handle,
-        bin_chunk_data,
-        bin_chunk.length,
-        &bytes_read,
-        &overlapped);
-    /*========================================================================*/
-    /* Copy Data to GPU                                                       */
-    /*========================================================================*/
-    /* Copy Data from Binary Chunk to Staging Buffer                          */
-    /*------------------------------------------------------------------------*/
-    vertex *vertices;
+    // Every model converts into its own range of the shared staging buffer
+    u8 *staging_data;
     vkMapMemory(
         vk_device,
         staging_memory,
         0,
-        vertex_buffer_size,
+        vertex_buffer_size + index_buffer_size,
         0,
-        (void **)&vertices);
-    for(u32 i= 0; i < gltf_json.mesh.primitive_count; ++i) {
-        gltf_mesh_primitive *gltf_primitive= &gltf_json.mesh.primitive_list[i];
-        /*--------------------------------------------------------------------*/
-        /* POSITION Attribute                                                 */
-        /*--------------------------------------------------------------------*/
-        gltf_accessor *pos_accessor=
-            &gltf_json.accessor_list[gltf_primitive->pos_accessor];
-        gltf_buffer_view *pos_buffer_view=
-            &gltf_json.buffer_view_list[pos_accessor->buffer_view];
-#define at_offset(addr, offset) ((void *)((u8 *)addr + offset))
-        vec3 *pos_data=
-            (vec3 *)at_offset(bin_chunk_data, pos_buffer_view->byte_offset);
-        pos_data= (vec3 *)at_offset(pos_data, pos_accessor->byte_offset);
-        /*--------------------------------------------------------------------*/
-        /* NORMAL Attribute                                                   */
-        /*--------------------------------------------------------------------*/
-        gltf_accessor *nrm_accessor=
-            &gltf_json.accessor_list[gltf_primitive->nrm_accessor];
-        gltf_buffer_view *nrm_buffer_view=
-            &gltf_json.buffer_view_list[nrm_accessor->buffer_view];
-        vec3 *nrm_data=
-            (vec3 *)at_offset(bin_chunk_data, nrm_buffer_view->byte_offset);
-        nrm_data= (vec3 *)at_offset(nrm_data, nrm_accessor->byte_offset);
-        for(u32 i= 0; i < pos_accessor->count; ++i) {
-            vertices[i].pos.x= pos_data[i].x;
-            vertices[i].pos.y= pos_data[i].y;
-            vertices[i].pos.z= pos_data[i].z;
-            vertices[i].pos.w= 1.0F;
-            vertices[i].nrm.x= nrm_data[i].x;
-            vertices[i].nrm.y= nrm_data[i].y;
-            vertices[i].nrm.z= nrm_data[i].z;
-            vertices[i].nrm.w= 0.F;
-        }
-    }
+        (void **)&staging_data);
+    glb_model_convert_batch convert_batch= {
+        .model_list= model_list,
+        .vertices  = staging_data,
+        .indices   = staging_data + vertex_buffer_size};
+    job_dispatch(glb_model_convert_job, &convert_batch, model_count);
     vkUnmapMemory(vk_device, staging_memory);
-    u16 *indices;
-    vkMapMemory(
-        vk_device,
-        staging_memory,
-        vertex_buffer_size,
-        index_buffer_size,
-        0,
-        (void **)&indices);
-    for(u32 i= 0; i < gltf_json.mesh.primitive_count; ++i) {
-        gltf_mesh_primitive *gltf_primitive= &gltf_json.mesh.primitive_list[i];
-        /*--------------------------------------------------------------------*/
-        /* INDEX                                                              */
-        /*--------------------------------------------------------------------*/
-        gltf_accessor *idx_accessor=
-            &gltf_json.accessor_list[gltf_primitive->idx_accessor];
-        gltf_buffer_view *idx_buffer_view=
-            &gltf_json.buffer_view_list[idx_accessor->buffer_view];
-        u16 *idx_data=
-            (u16 *)at_offset(bin_chunk_data, idx_buffer_view->byte_offset);
-        for(u32 i= 0; i < idx_accessor->count; ++i) { *indices++= idx_data[i]; }
-#undef at_offset
+    for(u32 i= 0; i < JOB_MAX_THREADS; ++i)
+        gltf_arena_reset(&gltf_json_arenas[i]);
+    // Models that failed halfway keep their buffer range but draw nothing
+    for(u32 m= 0; m < model_count; ++m) {
+        glb_model *model= &model_list[m];
+        if(model->loaded) continue;
+        for(u32 i= 0; i < model->primitive_count; ++i)
+            mesh_prim_list[model->first_primitive + i].index_count= 0;
     }
-    vkUnmapMemory(vk_device, staging_memory);
+    mesh_cluster_list cluster_list  = {0};
+    void             *cluster_memory= null;
+    u32              *cluster_ranges= null;
+    if(load_options.cluster_culling) {
+        cluster_memory= glb_merge_clusters(
+            model_list,
+            model_count,
+            mesh_prim_list,
+            &cluster_list,
+            &cluster_ranges);
+    }
+    mesh_prim_count= mesh_primitive_sort_draws(mesh_prim_list, mesh_prim_count);
+    if(load_options.optimize_meshes)
+        glb_report_cache_stats(model_list, model_count);
+    if(load_options.generate_lods)
+        glb_report_lod_stats(model_list, model_count);
+    glb_report_normal_stats(model_list, model_count);
+    /*========================================================================*/
+    /* Copy Data to GPU                                                       */
+    /*========================================================================*/
     /*------------------------------------------------------------------------*/
     /* Copy Data from Staging Buffer to Vertex Buffer and Index Buffer        */
     /*------------------------------------------------------------------------*/
@@ -2230,14 +6625,28 @@ main() {
     /*------------------------------------------------------------------------*/
     vkDestroyBuffer(vk_device, staging_buffer, NULL);
     vkFreeMemory(vk_device, staging_memory, NULL);
-    HeapFree(process_heap, 0, bin_chunk_data);
-    CloseHandle(file_handle);
     /*========================================================================*/
     /* Main Loop                                                              */
     /*========================================================================*/
     running= TRUE;
-    while(running) {
-        vulkan_render_frame(mesh_prim_count, mesh_prim_list);
+    for(u32 frame= 0; running; ++frame) {
+        glb_frame_stats frame_stats= vulkan_render_frame(
+            mesh_prim_count,
+            mesh_prim_list,
+            cluster_memory ? &cluster_list : null,
+            cluster_ranges);
+        if(load_options.generate_lods && frame == 0) {
+            bench_print("lods, ");
+            bench_print_u64(frame_stats.triangle_count);
+            bench_print(" triangles drawn in the first frame\n");
+        }
+        if(cluster_memory && frame == 0) {
+            bench_print("clusters, ");
+            bench_print_u64(frame_stats.visible_clusters);
+            bench_print(" of ");
+            bench_print_u64(cluster_list.count);
+            bench_print(" visible in the first frame\n");
+        }
         MSG msg= {0};
         while(PeekMessage(&msg, NULL, 0, 00, PM_REMOVE)) {
             TranslateMessage(&msg);
@@ -2245,12 +6654,15 @@ main() {
         }
     }
     /*========================================================================*/
+    job_system_shutdown();
     vkDestroyImageView(vk_device, vk_depth_image_view, NULL);
     vkDestroyImage(vk_device, vk_depth_image, NULL);
     vkFreeMemory(vk_device, vk_depth_memory, NULL);
     vkDestroyBuffer(vk_device, vk_vertex_buffer, NULL);
     vkDestroyBuffer(vk_device, vk_index_buffer, NULL);
     HeapFree(process_heap, 0, mesh_prim_list);
+    if(cluster_memory) HeapFree(process_heap, 0, cluster_memory);
+    if(cluster_ranges) HeapFree(process_heap, 0, cluster_ranges);
     vkFreeMemory(vk_device, vk_buffer_memory, NULL);
     vkDestroySemaphore(vk_device, vk_acquire_semaphore, NULL);
     vulkan_destroy_swapchain_attachments();
@@ -2267,8 +6679,8 @@ main() {
     vkDestroyDebugUtilsMessengerEXT(vk_instance, vk_dbg_messenger, NULL);
     vkDestroyInstance(vk_instance, NULL);
     FreeLibrary(vulkan_library);
-    g_allocator.free(gltf_json.accessor_list);
-    g_allocator.free(gltf_json.buffer_view_list);
-    g_allocator.free(gltf_json.mesh.primitive_list);
+    HeapFree(process_heap, 0, model_list);
+    for(u32 i= 0; i < JOB_MAX_THREADS; ++i)
+        gltf_token_arena_release(&gltf_token_arenas[i]);
     ExitProcess(0);
 }
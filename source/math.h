@@ -1,3 +1,7 @@
+#pragma once
+
+#include <intrin.h>
+
 #include "types.h"
 
 #define M_DEG_2_RAD 0.01745329251994329576F
@@ -75,6 +79,29 @@ vec4_mul(const vec4 *_1, const vec4 *_2, vec4 *out) {
     out->w= temp.w;
 }
 
+static inline f32
+sqrt_f32(f32 value) {
+    return _mm_cvtss_f32(_mm_sqrt_ss(_mm_set_ss(value)));
+}
+
+static inline f32
+vec3_dot(vec3 a, vec3 b) {
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+static inline vec3
+vec3_sub(vec3 a, vec3 b) {
+    return vec3_make(a.x - b.x, a.y - b.y, a.z - b.z);
+}
+
+static inline vec3
+vec3_cross(vec3 a, vec3 b) {
+    return vec3_make(
+        a.y * b.z - a.z * b.y,
+        a.z * b.x - a.x * b.z,
+        a.x * b.y - a.y * b.x);
+}
+
 static inline void
 mat4x4_transpose(const mat4x4 *_mat, mat4x4 *out) {
     vec4 col1= {_mat->data[0], _mat->data[4], _mat->data[8], _mat->data[12]};
@@ -0,0 +1,308 @@
+#include <intrin.h>
+
+#include "mesh_cluster.h"
+#include "math.h"
+
+u64
+mesh_cluster_list_size(u32 count) {
+    return (2 * sizeof(u32) + 2 * sizeof(vec4) + 3 * sizeof(vec3)) *
+           (u64)count;
+}
+
+void
+mesh_cluster_list_init(mesh_cluster_list *list, void *memory, u32 count) {
+    // The 16-byte fields go first and keep their alignment
+    list->count      = count;
+    list->sphere     = memory;
+    list->cone       = list->sphere + count;
+    list->aabb_min   = (vec3 *)(list->cone + count);
+    list->aabb_max   = list->aabb_min + count;
+    list->cone_apex  = list->aabb_max + count;
+    list->first_index= (u32 *)(list->cone_apex + count);
+    list->index_count= list->first_index + count;
+}
+
+void
+mesh_cluster_list_copy(
+    mesh_cluster_list       *dest,
+    u32                      dest_first,
+    const mesh_cluster_list *source,
+    u32                      source_first,
+    u32                      count) {
+#define MESH_CLUSTER_COPY(field)                                               \
+    __movsb(                                                                   \
+        (u8 *)(dest->field + dest_first),                                      \
+        (const u8 *)(source->field + source_first),                            \
+        sizeof(*dest->field) * (u64)count)
+    MESH_CLUSTER_COPY(first_index);
+    MESH_CLUSTER_COPY(index_count);
+    MESH_CLUSTER_COPY(sphere);
+    MESH_CLUSTER_COPY(aabb_min);
+    MESH_CLUSTER_COPY(aabb_max);
+    MESH_CLUSTER_COPY(cone_apex);
+    MESH_CLUSTER_COPY(cone);
+#undef MESH_CLUSTER_COPY
+}
+
+/*============================================================================*/
+/* Bounds                                                                     */
+/*============================================================================*/
+/* The sphere is centered on the AABB. The cone follows meshoptimizer's
+ * cluster bounds: its axis is the average triangle normal, its apex is
+ * moved back along the axis until every triangle plane lies in front of
+ * it, and clusters with a normal more than about 84 degrees off the axis
+ * get no cone. */
+static void
+mesh_cluster_bounds(
+    const u32         *indices,
+    u32                first_index,
+    u32                index_count,
+    const vec3        *positions,
+    mesh_cluster_list *list,
+    u32                cluster) {
+    list->first_index[cluster]= first_index;
+    list->index_count[cluster]= index_count;
+    indices+= first_index;
+    vec3 aabb_min= positions[indices[0]];
+    vec3 aabb_max= aabb_min;
+    for(u32 i= 1; i < index_count; ++i) {
+        vec3 pos= positions[indices[i]];
+        for(u32 c= 0; c < 3; ++c) {
+            if(pos.data[c] < aabb_min.data[c]) aabb_min.data[c]= pos.data[c];
+            if(pos.data[c] > aabb_max.data[c]) aabb_max.data[c]= pos.data[c];
+        }
+    }
+    vec3 center= vec3_make(
+        (aabb_min.x + aabb_max.x) * 0.5F,
+        (aabb_min.y + aabb_max.y) * 0.5F,
+        (aabb_min.z + aabb_max.z) * 0.5F);
+    f32 radius_squared= 0.F;
+    for(u32 i= 0; i < index_count; ++i) {
+        vec3 offset  = vec3_sub(positions[indices[i]], center);
+        f32  distance= vec3_dot(offset, offset);
+        if(distance > radius_squared) radius_squared= distance;
+    }
+    /*------------------------------------------------------------------------*/
+    /* Normal Cone                                                            */
+    /*------------------------------------------------------------------------*/
+    vec3 axis= vec3_make(0.F, 0.F, 0.F);
+    for(u32 i= 0; i < index_count; i+= 3) {
+        vec3 a     = positions[indices[i]];
+        vec3 normal= vec3_cross(
+            vec3_sub(positions[indices[i + 1]], a),
+            vec3_sub(positions[indices[i + 2]], a));
+        f32 length= sqrt_f32(vec3_dot(normal, normal));
+        if(length == 0.F) continue;
+        for(u32 c= 0; c < 3; ++c) axis.data[c]+= normal.data[c] / length;
+    }
+    f32 axis_length= sqrt_f32(vec3_dot(axis, axis));
+    f32 min_dot    = -1.F;
+    f32 max_t      = 0.F;
+    if(axis_length > 0.F) {
+        for(u32 c= 0; c < 3; ++c) axis.data[c]/= axis_length;
+        min_dot= 1.F;
+        for(u32 i= 0; i < index_count; i+= 3) {
+            vec3 a     = positions[indices[i]];
+            vec3 normal= vec3_cross(
+                vec3_sub(positions[indices[i + 1]], a),
+                vec3_sub(positions[indices[i + 2]], a));
+            f32 length= sqrt_f32(vec3_dot(normal, normal));
+            if(length == 0.F) continue;
+            for(u32 c= 0; c < 3; ++c) normal.data[c]/= length;
+            f32 dot= vec3_dot(normal, axis);
+            if(dot < min_dot) min_dot= dot;
+            if(dot <= 0.1F) continue;
+            // The apex sits on the plane of the triangle at center - t * axis
+            f32 t= vec3_dot(vec3_sub(center, a), normal) / dot;
+            if(t > max_t) max_t= t;
+        }
+    }
+    f32 radius              = sqrt_f32(radius_squared);
+    list->sphere[cluster]   = (vec4){center.x, center.y, center.z, radius};
+    list->aabb_min[cluster] = aabb_min;
+    list->aabb_max[cluster] = aabb_max;
+    list->cone_apex[cluster]= vec3_make(
+        center.x - axis.x * max_t,
+        center.y - axis.y * max_t,
+        center.z - axis.z * max_t);
+    list->cone[cluster]= (vec4){axis.x, axis.y, axis.z, 1.F};
+    if(min_dot > 0.1F)
+        list->cone[cluster].w= sqrt_f32(1.F - min_dot * min_dot);
+}
+
+u32
+mesh_build_clusters(
+    const u32         *indices,
+    u32                index_count,
+    u32                vertex_count,
+    const vec3        *positions,
+    u32               *scratch,
+    mesh_cluster_list *list,
+    u32                first_cluster) {
+    if(index_count % 3) return 0;
+    for(u32 i= 0; i < index_count; ++i)
+        if(indices[i] >= vertex_count) return 0;
+    // The cluster that last used each vertex
+    u32 *cluster_of= scratch;
+    __stosb((u8 *)cluster_of, 0xFF, sizeof(u32) * (u64)vertex_count);
+    u32 cluster_count = 0;
+    u32 first_index   = 0;
+    u32 vertex_total  = 0;
+    u32 triangle_total= 0;
+    for(u32 i= 0; i < index_count; i+= 3) {
+        u32 new_vertices= 0;
+        for(u32 c= 0; c < 3; ++c)
+            new_vertices+= cluster_of[indices[i + c]] != cluster_count;
+        if(triangle_total &&
+           (vertex_total + new_vertices > MESH_CLUSTER_MAX_VERTICES ||
+            triangle_total == MESH_CLUSTER_MAX_TRIANGLES)) {
+            if(list) {
+                mesh_cluster_bounds(
+                    indices,
+                    first_index,
+                    i - first_index,
+                    positions,
+                    list,
+                    first_cluster + cluster_count);
+            }
+            ++cluster_count;
+            first_index   = i;
+            vertex_total  = 0;
+            triangle_total= 0;
+        }
+        for(u32 c= 0; c < 3; ++c) {
+            u32 vertex= indices[i + c];
+            if(cluster_of[vertex] == cluster_count) continue;
+            cluster_of[vertex]= cluster_count;
+            ++vertex_total;
+        }
+        ++triangle_total;
+    }
+    if(triangle_total) {
+        if(list) {
+            mesh_cluster_bounds(
+                indices,
+                first_index,
+                index_count - first_index,
+                positions,
+                list,
+                first_cluster + cluster_count);
+        }
+        ++cluster_count;
+    }
+    return cluster_count;
+}
+
+/*============================================================================*/
+/* Culling                                                                    */
+/*============================================================================*/
+void
+mesh_cull_view_make(const mat4x4 *clip_from_model, mesh_cull_view *out) {
+    vec4 rows[4];
+    for(u32 r= 0; r < 4; ++r) {
+        for(u32 c= 0; c < 4; ++c)
+            rows[r].data[c]= clip_from_model->columns[c].data[r];
+    }
+    // -w <= x, y <= w and 0 <= z <= w
+    for(u32 c= 0; c < 4; ++c) {
+        out->planes[0].data[c]= rows[3].data[c] + rows[0].data[c];
+        out->planes[1].data[c]= rows[3].data[c] - rows[0].data[c];
+        out->planes[2].data[c]= rows[3].data[c] + rows[1].data[c];
+        out->planes[3].data[c]= rows[3].data[c] - rows[1].data[c];
+        out->planes[4].data[c]= rows[2].data[c];
+        out->planes[5].data[c]= rows[3].data[c] - rows[2].data[c];
+    }
+    for(u32 p= 0; p < 6; ++p) {
+        vec4 *plane = &out->planes[p];
+        f32   length= sqrt_f32(
+            plane->x * plane->x + plane->y * plane->y + plane->z * plane->z);
+        if(length == 0.F) continue;
+        for(u32 c= 0; c < 4; ++c) plane->data[c]/= length;
+    }
+    /*------------------------------------------------------------------------*/
+    /* Eye Point                                                              */
+    /*------------------------------------------------------------------------*/
+    // The point clip x, y and w all vanish at, eye[k] is (-1)^k times the
+    // minor of the x, y and w rows without column k. The screen area of a
+    // triangle then is proportional to eye.w * dot(normal, eye - corner),
+    // so only a positive w keeps counter-clockwise triangles facing the eye
+    // in front, and a w near 0 is a view without an eye point
+    const vec4 *x= &rows[0], *y= &rows[1], *w= &rows[3];
+    f32         minors[4];
+    for(u32 k= 0; k < 4; ++k) {
+        u32 a= k == 0 ? 1 : 0;
+        u32 b= k <= 1 ? 2 : 1;
+        u32 c= k <= 2 ? 3 : 2;
+        minors[k]=
+            x->data[a] * (y->data[b] * w->data[c] - y->data[c] * w->data[b]) -
+            x->data[b] * (y->data[a] * w->data[c] - y->data[c] * w->data[a]) +
+            x->data[c] * (y->data[a] * w->data[b] - y->data[b] * w->data[a]);
+    }
+    vec4 eye= {minors[0], -minors[1], minors[2], -minors[3]};
+    f32  eye_extent=
+        (eye.x < 0 ? -eye.x : eye.x) + (eye.y < 0 ? -eye.y : eye.y) +
+        (eye.z < 0 ? -eye.z : eye.z);
+    out->camera= vec3_make(0.F, 0.F, 0.F);
+    out->cones = eye.w > 0.F && eye.w > 1e-6F * eye_extent;
+    if(out->cones)
+        out->camera= vec3_make(eye.x / eye.w, eye.y / eye.w, eye.z / eye.w);
+}
+
+static bool
+mesh_cluster_visible(
+    const mesh_cluster_list *list,
+    u32                      cluster,
+    const mesh_cull_view    *view) {
+    vec4 sphere= list->sphere[cluster];
+    for(u32 p= 0; p < 6; ++p) {
+        const vec4 *plane= &view->planes[p];
+        if(plane->x * sphere.x + plane->y * sphere.y + plane->z * sphere.z +
+               plane->w <
+           -sphere.w)
+            return false;
+    }
+    // The AABB corner furthest along each plane normal
+    vec3 aabb_min= list->aabb_min[cluster];
+    vec3 aabb_max= list->aabb_max[cluster];
+    for(u32 p= 0; p < 6; ++p) {
+        const vec4 *plane= &view->planes[p];
+        f32         x    = plane->x >= 0.F ? aabb_max.x : aabb_min.x;
+        f32         y    = plane->y >= 0.F ? aabb_max.y : aabb_min.y;
+        f32         z    = plane->z >= 0.F ? aabb_max.z : aabb_min.z;
+        if(plane->x * x + plane->y * y + plane->z * z + plane->w < 0.F)
+            return false;
+    }
+    vec4 cone= list->cone[cluster];
+    if(!view->cones || cone.w >= 1.F) return true;
+    // Culled when the eye lies in the cone opening behind the apex
+    vec3 axis    = vec3_make(cone.x, cone.y, cone.z);
+    vec3 offset  = vec3_sub(list->cone_apex[cluster], view->camera);
+    f32  distance= sqrt_f32(vec3_dot(offset, offset));
+    return vec3_dot(offset, axis) < cone.w * distance;
+}
+
+u32
+mesh_cull_clusters(
+    const mesh_cluster_list *list,
+    u32                      first,
+    u32                      count,
+    const mesh_cull_view    *view,
+    u32                     *ranges,
+    u32                     *visible_count) {
+    u32 range_count= 0;
+    *visible_count = 0;
+    for(u32 i= first; i < first + count; ++i) {
+        if(!mesh_cluster_visible(list, i, view)) continue;
+        ++*visible_count;
+        if(range_count && ranges[2 * range_count - 2] +
+                                  ranges[2 * range_count - 1] ==
+                              list->first_index[i]) {
+            ranges[2 * range_count - 1]+= list->index_count[i];
+            continue;
+        }
+        ranges[2 * range_count]    = list->first_index[i];
+        ranges[2 * range_count + 1]= list->index_count[i];
+        ++range_count;
+    }
+    return range_count;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "types.h"
+
+/* Splits indexed triangle lists into clusters of consecutive triangles with
+ * at most MESH_CLUSTER_MAX_VERTICES distinct vertices and
+ * MESH_CLUSTER_MAX_TRIANGLES triangles, so every cluster is a contiguous
+ * index range the draw can start and stop at. Each cluster gets a bounding
+ * sphere, an AABB and a backface cone, and the culling pass turns the
+ * clusters that survive a view into merged index ranges. */
+#define MESH_CLUSTER_MAX_VERTICES  64u
+#define MESH_CLUSTER_MAX_TRIANGLES 124u
+
+/* One array per field, culling reads the spheres of every cluster and the
+ * rest only for the clusters that get that far. Bounds are in the space of
+ * the positions the clusters were built from. */
+typedef struct mesh_cluster_list {
+    u32   count;
+    u32  *first_index; // relative to the first index of the primitive
+    u32  *index_count;
+    vec4 *sphere; // center and radius
+    vec3 *aabb_min;
+    vec3 *aabb_max;
+    vec3 *cone_apex;
+    // Axis and cutoff, the cosine of the cone's half angle, with a cutoff
+    // of 1 for clusters whose triangles face too many ways to be culled
+    vec4 *cone;
+} mesh_cluster_list;
+
+/* A view in the space of the cluster bounds. */
+typedef struct mesh_cull_view {
+    vec4 planes[6]; // inside where dot(xyz, p) + w >= 0, normalized
+    vec3 camera;
+    // False for mirrored views and views without an eye point, which skip
+    // the cone test
+    bool cones;
+} mesh_cull_view;
+
+u64
+mesh_cluster_list_size(u32 count);
+/* Points the arrays of `list` into `memory` of mesh_cluster_list_size()
+ * bytes. */
+void
+mesh_cluster_list_init(mesh_cluster_list *list, void *memory, u32 count);
+void
+mesh_cluster_list_copy(
+    mesh_cluster_list       *dest,
+    u32                      dest_first,
+    const mesh_cluster_list *source,
+    u32                      source_first,
+    u32                      count);
+/* Returns the number of clusters and, with a non-null `list`, writes them
+ * from `first_cluster` on. `scratch` holds one u32 per vertex. Lists with
+ * an index past `vertex_count` or a count that isn't a multiple of 3 get
+ * no clusters. */
+u32
+mesh_build_clusters(
+    const u32         *indices,
+    u32                index_count,
+    u32                vertex_count,
+    const vec3        *positions,
+    u32               *scratch,
+    mesh_cluster_list *list,
+    u32                first_cluster);
+/* `clip_from_model` maps the space of the bounds to clip space, column
+ * major for column vectors, with Vulkan's depth range. Front faces are the
+ * ones counter-clockwise in normalized device coordinates with y up. */
+void
+mesh_cull_view_make(const mat4x4 *clip_from_model, mesh_cull_view *out);
+/* Writes (first index, index count) pairs of the visible clusters among
+ * `count` clusters from `first`, with neighbours merged into one range, and
+ * returns the number of pairs. `visible_count` receives the number of
+ * clusters that passed. */
+u32
+mesh_cull_clusters(
+    const mesh_cluster_list *list,
+    u32                      first,
+    u32                      count,
+    const mesh_cull_view    *view,
+    u32                     *ranges,
+    u32                     *visible_count);
@@ -0,0 +1,103 @@
+#include <intrin.h>
+
+#include "mesh_normals.h"
+#include "math.h"
+
+static bool
+mesh_triangle_in_range(const u32 *corners, u32 vertex_count) {
+    return corners[0] < vertex_count && corners[1] < vertex_count &&
+           corners[2] < vertex_count;
+}
+
+void
+mesh_normal_chunk_span(mesh_normal_chunk *chunk, u32 vertex_count) {
+    u32 first= ~0u;
+    u32 last = 0;
+    // Branch-free over every index first, only chunks with an index out of
+    // range need the triangles checked one by one
+    for(u32 i= 0; i < chunk->index_count; ++i) {
+        u32 index= chunk->indices[i];
+        first    = index < first ? index : first;
+        last     = index > last ? index : last;
+    }
+    if(last < vertex_count) {
+        chunk->first_vertex= first == ~0u ? 0 : first;
+        chunk->vertex_count= first == ~0u ? 0 : last - first + 1;
+        return;
+    }
+    first= ~0u;
+    last = 0;
+    for(u32 i= 0; i + 2 < chunk->index_count; i+= 3) {
+        const u32 *corners= &chunk->indices[i];
+        if(!mesh_triangle_in_range(corners, vertex_count)) continue;
+        for(u32 k= 0; k < 3; ++k) {
+            if(corners[k] < first) first= corners[k];
+            if(corners[k] > last) last= corners[k];
+        }
+    }
+    chunk->first_vertex= first == ~0u ? 0 : first;
+    chunk->vertex_count= first == ~0u ? 0 : last - first + 1;
+}
+
+void
+mesh_normal_chunk_sum(
+    mesh_normal_chunk *chunk,
+    const vec3        *positions,
+    u32                vertex_count) {
+    vec3 *sums= chunk->sums;
+    __stosb((u8 *)sums, 0, sizeof(vec3) * (u64)chunk->vertex_count);
+    for(u32 i= 0; i + 2 < chunk->index_count; i+= 3) {
+        const u32 *corners= &chunk->indices[i];
+        if(!mesh_triangle_in_range(corners, vertex_count)) continue;
+        vec3 p0    = positions[corners[0]];
+        vec3 normal= vec3_cross(
+            vec3_sub(positions[corners[1]], p0),
+            vec3_sub(positions[corners[2]], p0));
+        for(u32 k= 0; k < 3; ++k) {
+            vec3 *sum= &sums[corners[k] - chunk->first_vertex];
+            sum->x+= normal.x;
+            sum->y+= normal.y;
+            sum->z+= normal.z;
+        }
+    }
+}
+
+void
+mesh_normals_resolve(
+    const mesh_normal_chunk *chunks,
+    u32                      chunk_count,
+    u32                      first_vertex,
+    u32                      count,
+    vec3                    *normals) {
+    __stosb((u8 *)normals, 0, sizeof(vec3) * (u64)count);
+    u64 end= (u64)first_vertex + count;
+    for(u32 c= 0; c < chunk_count; ++c) {
+        const mesh_normal_chunk *chunk= &chunks[c];
+        u64                      from = chunk->first_vertex;
+        u64                      to   = from + chunk->vertex_count;
+        if(from < first_vertex) from= first_vertex;
+        if(to > end) to= end;
+        // Both sides run over consecutive vertices, the adds stream
+        for(u64 v= from; v < to; ++v) {
+            const vec3 *sum   = &chunk->sums[v - chunk->first_vertex];
+            vec3       *normal= &normals[v - first_vertex];
+            normal->x+= sum->x;
+            normal->y+= sum->y;
+            normal->z+= sum->z;
+        }
+    }
+    for(u32 i= 0; i < count; ++i) {
+        vec3 *normal       = &normals[i];
+        f32  length_squared= normal->x * normal->x + normal->y * normal->y +
+                             normal->z * normal->z;
+        // Also catches sums that overflowed or came from non-finite input
+        if(!(length_squared > 0.F && length_squared < 3.4e38F)) {
+            *normal= vec3_make(0.F, 0.F, 1.F);
+            continue;
+        }
+        f32 inv_length= 1.F / sqrt_f32(length_squared);
+        normal->x*= inv_length;
+        normal->y*= inv_length;
+        normal->z*= inv_length;
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "types.h"
+
+/* Area-weighted smooth vertex normals of indexed triangle lists, for
+ * primitives that come without a NORMAL attribute. Every triangle adds its
+ * unnormalized face normal, twice its area long, to its three vertices. The
+ * triangles are split into chunks that each sum into a private array
+ * covering only the vertices the chunk references, so chunks run in
+ * parallel without atomics or writes into shared memory, and a pass over
+ * vertex ranges adds the chunks up in order. Triangles of a mesh in any
+ * locality-preserving order reference few vertices per chunk, the private
+ * arrays then add up to little more than one array for the mesh, and the
+ * result doesn't depend on how the passes were scheduled. */
+
+typedef struct mesh_normal_chunk {
+    const u32 *indices;
+    u32        index_count;  // a multiple of 3
+    u32        first_vertex; // lowest vertex of the chunk's triangles
+    u32        vertex_count; // vertices from first_vertex on the sums cover
+    vec3      *sums;
+} mesh_normal_chunk;
+
+/* Sets the vertex span of the chunk, triangles with an index past
+ * `vertex_count` are left out here and when summing. */
+void
+mesh_normal_chunk_span(mesh_normal_chunk *chunk, u32 vertex_count);
+/* Fills the chunk's sums, which have to hold its vertex span. */
+void
+mesh_normal_chunk_sum(
+    mesh_normal_chunk *chunk,
+    const vec3        *positions,
+    u32                vertex_count);
+/* Writes the unit normals of `count` vertices from `first_vertex` on into
+ * `normals`, from the sums of `chunk_count` chunks of the same mesh. Vertices
+ * without any triangle area around them get +z. */
+void
+mesh_normals_resolve(
+    const mesh_normal_chunk *chunks,
+    u32                      chunk_count,
+    u32                      first_vertex,
+    u32                      count,
+    vec3                    *normals);
@@ -0,0 +1,168 @@
+#include <intrin.h>
+
+#include "mesh_optimize.h"
+
+u64
+mesh_optimize_scratch_size(u32 index_count, u32 vertex_count) {
+    // Adjacency offsets and lists, live counts, cache timestamps, the
+    // dead-end stack, fan candidates, the output and the emitted flags
+    return sizeof(u32) * (3ull * vertex_count + 1 + 4ull * index_count) +
+           index_count / 3;
+}
+
+bool
+mesh_triangles_valid(const u32 *indices, u32 index_count, u32 vertex_count) {
+    if(index_count % 3) return false;
+    for(u32 i= 0; i < index_count; ++i)
+        if(indices[i] >= vertex_count) return false;
+    return true;
+}
+
+/*============================================================================*/
+/* Statistics                                                                 */
+/*============================================================================*/
+/* A vertex is in the FIFO while fewer than MESH_VERTEX_CACHE_SIZE misses
+ * came after its own, so one timestamp per vertex replaces the queue. The
+ * clock starts past the cache size, a zero timestamp means never seen. */
+void
+mesh_analyze_vertex_cache(
+    const u32        *indices,
+    u32               index_count,
+    u32               vertex_count,
+    void             *scratch,
+    mesh_cache_stats *stats) {
+    u32 *cache_time= scratch;
+    __stosb((u8 *)cache_time, 0, sizeof(u32) * (u64)vertex_count);
+    u32 time= MESH_VERTEX_CACHE_SIZE + 1;
+    for(u32 i= 0; i < index_count; ++i) {
+        u32 vertex= indices[i];
+        if(!cache_time[vertex]) ++stats->vertex_count;
+        if(time - cache_time[vertex] > MESH_VERTEX_CACHE_SIZE) {
+            cache_time[vertex]= time++;
+            ++stats->transform_count;
+        }
+    }
+    stats->triangle_count+= index_count / 3;
+}
+
+f64
+mesh_cache_acmr(const mesh_cache_stats *stats) {
+    if(!stats->triangle_count) return 0.0;
+    return (f64)stats->transform_count / (f64)stats->triangle_count;
+}
+
+f64
+mesh_cache_atvr(const mesh_cache_stats *stats) {
+    if(!stats->vertex_count) return 0.0;
+    return (f64)stats->transform_count / (f64)stats->vertex_count;
+}
+
+/*============================================================================*/
+/* Tipsify                                                                    */
+/*============================================================================*/
+/* Emits every remaining triangle around a fanning vertex, then moves on to
+ * the vertex of those triangles that stays cached the longest once its own
+ * remaining triangles are emitted. With no such vertex the fan restarts
+ * from the most recently used vertex that still has triangles, and last
+ * from the lowest one. */
+void
+mesh_optimize_vertex_cache(
+    u32  *indices,
+    u32   index_count,
+    u32   vertex_count,
+    void *scratch) {
+    u32  triangle_count= index_count / 3;
+    u32 *offsets       = scratch;
+    u32 *adjacency     = offsets + vertex_count + 1;
+    u32 *live          = adjacency + index_count;
+    u32 *cache_time    = live + vertex_count;
+    u32 *dead_end      = cache_time + vertex_count;
+    u32 *candidates    = dead_end + index_count;
+    u32 *output        = candidates + index_count;
+    u8  *emitted       = (u8 *)(output + index_count);
+    if(!triangle_count) return;
+    /*------------------------------------------------------------------------*/
+    /* Triangles around every Vertex                                          */
+    /*------------------------------------------------------------------------*/
+    __stosb((u8 *)live, 0, sizeof(u32) * (u64)vertex_count);
+    for(u32 i= 0; i < index_count; ++i) ++live[indices[i]];
+    offsets[0]= 0;
+    for(u32 v= 0; v < vertex_count; ++v) {
+        offsets[v + 1]= offsets[v] + live[v];
+        cache_time[v] = offsets[v];
+    }
+    for(u32 i= 0; i < index_count; ++i)
+        adjacency[cache_time[indices[i]]++]= i / 3;
+    __stosb((u8 *)cache_time, 0, sizeof(u32) * (u64)vertex_count);
+    __stosb(emitted, 0, triangle_count);
+    /*------------------------------------------------------------------------*/
+    /* Fans                                                                   */
+    /*------------------------------------------------------------------------*/
+    u32 time          = MESH_VERTEX_CACHE_SIZE + 1;
+    u32 cursor        = 0;
+    u32 dead_end_count= 0;
+    u32 output_count  = 0;
+    u32 fan           = indices[0];
+    while(fan != ~(0u)) {
+        u32 candidate_count= 0;
+        for(u32 a= offsets[fan]; a < offsets[fan + 1]; ++a) {
+            u32 triangle= adjacency[a];
+            if(emitted[triangle]) continue;
+            emitted[triangle]= 1;
+            for(u32 c= 0; c < 3; ++c) {
+                u32 vertex                   = indices[3 * triangle + c];
+                output[output_count++]       = vertex;
+                dead_end[dead_end_count++]   = vertex;
+                candidates[candidate_count++]= vertex;
+                --live[vertex];
+                if(time - cache_time[vertex] > MESH_VERTEX_CACHE_SIZE)
+                    cache_time[vertex]= time++;
+            }
+        }
+        fan              = ~(0u);
+        u64 best_priority= 0;
+        for(u32 i= 0; i < candidate_count; ++i) {
+            u32 vertex= candidates[i];
+            if(!live[vertex]) continue;
+            // Vertices that would drop out of the cache before their last
+            // triangle all rank below the ones that don't
+            u64 age     = time - cache_time[vertex];
+            u64 priority= 1;
+            if(age + 2ull * live[vertex] <= MESH_VERTEX_CACHE_SIZE)
+                priority= age + 1;
+            if(priority > best_priority) {
+                best_priority= priority;
+                fan          = vertex;
+            }
+        }
+        while(fan == ~(0u) && dead_end_count) {
+            u32 vertex= dead_end[--dead_end_count];
+            if(live[vertex]) fan= vertex;
+        }
+        while(fan == ~(0u) && cursor < vertex_count) {
+            if(live[cursor]) fan= cursor;
+            else ++cursor;
+        }
+    }
+    __movsb((u8 *)indices, (const u8 *)output, sizeof(u32) * (u64)index_count);
+}
+
+/*============================================================================*/
+/* Vertex Fetch                                                               */
+/*============================================================================*/
+void
+mesh_optimize_vertex_fetch(
+    u32 *indices,
+    u32  index_count,
+    u32  vertex_count,
+    u32 *remap) {
+    __stosb((u8 *)remap, 0xFF, sizeof(u32) * (u64)vertex_count);
+    u32 next= 0;
+    for(u32 i= 0; i < index_count; ++i) {
+        u32 vertex= indices[i];
+        if(remap[vertex] == ~(0u)) remap[vertex]= next++;
+        indices[i]= remap[vertex];
+    }
+    for(u32 v= 0; v < vertex_count; ++v)
+        if(remap[v] == ~(0u)) remap[v]= next++;
+}
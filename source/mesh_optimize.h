@@ -0,0 +1,59 @@
+#pragma once
+
+#include "types.h"
+
+/* Load-time reordering of indexed triangle lists. The triangle order is
+ * optimized for the post-transform vertex cache with Tipsify (Sander, Nehab
+ * and Barczak 2007), which runs in linear time, and the vertices are then
+ * renumbered in the order the triangles first use them, so vertex fetch
+ * walks the vertex buffer front to back. Every function works on 32-bit
+ * indices and takes its memory from a scratch block of
+ * mesh_optimize_scratch_size() bytes. */
+
+// FIFO entries assumed by the optimizer and by the statistics
+#define MESH_VERTEX_CACHE_SIZE 16u
+
+/* Counters of a vertex cache simulation, they add up over primitives.
+ * ACMR is transforms per triangle, from 3 down to about 0.5 for regular
+ * grids, ATVR is transforms per vertex with 1 as the optimum. */
+typedef struct mesh_cache_stats {
+    u64 triangle_count;
+    u64 vertex_count;
+    u64 transform_count;
+} mesh_cache_stats;
+
+u64
+mesh_optimize_scratch_size(u32 index_count, u32 vertex_count);
+/* False for lists the functions below can't take, a count that isn't a
+ * multiple of 3 or an index past `vertex_count`. */
+bool
+mesh_triangles_valid(const u32 *indices, u32 index_count, u32 vertex_count);
+/* Simulates a FIFO cache of MESH_VERTEX_CACHE_SIZE entries and adds the
+ * transforms to `stats`. */
+void
+mesh_analyze_vertex_cache(
+    const u32        *indices,
+    u32               index_count,
+    u32               vertex_count,
+    void             *scratch,
+    mesh_cache_stats *stats);
+f64
+mesh_cache_acmr(const mesh_cache_stats *stats);
+f64
+mesh_cache_atvr(const mesh_cache_stats *stats);
+/* Reorders the triangles in place, every triangle keeps its winding. */
+void
+mesh_optimize_vertex_cache(
+    u32  *indices,
+    u32   index_count,
+    u32   vertex_count,
+    void *scratch);
+/* Renumbers the vertices in first-use order and rewrites the indices, the
+ * vertex at old position i moves to remap[i]. Vertices no triangle uses
+ * keep their relative order behind the used ones. */
+void
+mesh_optimize_vertex_fetch(
+    u32 *indices,
+    u32  index_count,
+    u32  vertex_count,
+    u32 *remap);
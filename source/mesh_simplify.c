@@ -0,0 +1,416 @@
+#include <intrin.h>
+
+#include "mesh_simplify.h"
+#include "math.h"
+#include "utils.h"
+
+// Collapses are sorted by the top bits of their error, sign excluded
+#define MESH_SIMPLIFY_SORT_BITS 11u
+
+#define MESH_VERTEX_LOCKED  1u // on an open or non-manifold edge
+#define MESH_VERTEX_TOUCHED 2u // collapsed from or onto in this pass
+
+/* Area-weighted sum of the plane equations of the triangles around a
+ * vertex, the symmetric matrix A, the vector b and the constant c of
+ * p'Ap + 2b'p + c. The terms cancel down to the error, which is orders of
+ * magnitude below each of them for mild reductions, so they are kept in
+ * f64 where f32 would round the error away. */
+typedef struct mesh_quadric {
+    f64 a00, a11, a22, a01, a12, a02;
+    f64 b0, b1, b2;
+    f64 c;
+    f64 weight;
+} mesh_quadric;
+
+/* An edge that can collapse, `from` moves onto `to`. */
+typedef struct mesh_collapse {
+    u32 from;
+    u32 to;
+    f32 error;
+} mesh_collapse;
+
+static f64
+mesh_sqrt_f64(f64 value) {
+    return _mm_cvtsd_f64(_mm_sqrt_sd(_mm_setzero_pd(), _mm_set_sd(value)));
+}
+
+u64
+mesh_simplify_scratch_size(u32 index_count, u32 vertex_count) {
+    // Scaled positions, position ids, the id table, quadrics, the collapse
+    // remap, adjacency offsets and lists, the sort, collapses and flags
+    return (sizeof(vec3) + 3 * sizeof(u32) + sizeof(mesh_quadric) + 1) *
+               (u64)vertex_count +
+           sizeof(u32) * (1 + hash_table_size(vertex_count) +
+                          (1u << MESH_SIMPLIFY_SORT_BITS)) +
+           (2 * sizeof(u32) + sizeof(mesh_collapse)) * (u64)index_count;
+}
+
+/*============================================================================*/
+/* Quadrics                                                                   */
+/*============================================================================*/
+static void
+mesh_quadric_add(mesh_quadric *dest, const mesh_quadric *source) {
+    f64       *d= (f64 *)dest;
+    const f64 *s= (const f64 *)source;
+    for(u32 i= 0; i < sizeof(mesh_quadric) / sizeof(f64); ++i) d[i]+= s[i];
+}
+
+/* The plane through the triangle, weighted by twice its area. */
+static bool
+mesh_quadric_from_triangle(vec3 p0, vec3 p1, vec3 p2, mesh_quadric *out) {
+    vec3 normal= vec3_cross(vec3_sub(p1, p0), vec3_sub(p2, p0));
+    f64  length= mesh_sqrt_f64(
+        (f64)normal.x * normal.x + (f64)normal.y * normal.y +
+        (f64)normal.z * normal.z);
+    if(length == 0.0) return false;
+    f64 x= normal.x / length, y= normal.y / length, z= normal.z / length;
+    f64 d= -(x * p0.x + y * p0.y + z * p0.z);
+    out->a00   = length * x * x;
+    out->a11   = length * y * y;
+    out->a22   = length * z * z;
+    out->a01   = length * x * y;
+    out->a12   = length * y * z;
+    out->a02   = length * x * z;
+    out->b0    = length * x * d;
+    out->b1    = length * y * d;
+    out->b2    = length * z * d;
+    out->c     = length * d * d;
+    out->weight= length;
+    return true;
+}
+
+/* Weighted mean squared distance of `p` to the planes. */
+static f32
+mesh_quadric_error(const mesh_quadric *q, vec3 p) {
+    f64 x= p.x, y= p.y, z= p.z;
+    f64 rx   = q->a00 * x + q->a01 * y + q->a02 * z + 2.0 * q->b0;
+    f64 ry   = q->a01 * x + q->a11 * y + q->a12 * z + 2.0 * q->b1;
+    f64 rz   = q->a02 * x + q->a12 * y + q->a22 * z + 2.0 * q->b2;
+    f64 error= rx * x + ry * y + rz * z + q->c;
+    if(error < 0.0) error= -error;
+    return q->weight > 0.0 ? (f32)(error / q->weight) : 0.F;
+}
+
+/*============================================================================*/
+/* Topology                                                                   */
+/*============================================================================*/
+/* Points every vertex at the first vertex with the same position. */
+static void
+mesh_simplify_position_ids(
+    const vec3 *positions,
+    u32         vertex_count,
+    u32        *table,
+    u32        *ids) {
+    u64 slot_mask= hash_table_size(vertex_count) - 1;
+    __stosb((u8 *)table, 0xFF, sizeof(u32) * (slot_mask + 1));
+    for(u32 v= 0; v < vertex_count; ++v) {
+        const u32 *position= (const u32 *)&positions[v];
+        u64        slot    = hash_words(position, 3) & slot_mask;
+        while(table[slot] != ~(0u)) {
+            const u32 *other= (const u32 *)&positions[table[slot]];
+            if(position[0] == other[0] && position[1] == other[1] &&
+               position[2] == other[2])
+                break;
+            slot= (slot + 1) & slot_mask;
+        }
+        if(table[slot] == ~(0u)) table[slot]= v;
+        ids[v]= table[slot];
+    }
+}
+
+/* Triangles around every position id, `cursor` is scratch of one u32 per
+ * vertex. */
+static void
+mesh_simplify_adjacency(
+    const u32 *indices,
+    u32        index_count,
+    const u32 *ids,
+    u32        vertex_count,
+    u32       *offsets,
+    u32       *adjacency,
+    u32       *cursor) {
+    __stosb((u8 *)cursor, 0, sizeof(u32) * (u64)vertex_count);
+    for(u32 i= 0; i < index_count; ++i) ++cursor[ids[indices[i]]];
+    offsets[0]= 0;
+    for(u32 v= 0; v < vertex_count; ++v) {
+        offsets[v + 1]= offsets[v] + cursor[v];
+        cursor[v]     = offsets[v];
+    }
+    for(u32 i= 0; i < index_count; ++i)
+        adjacency[cursor[ids[indices[i]]]++]= i / 3;
+}
+
+/* Locks both ends of every edge that doesn't have exactly two triangles. */
+static void
+mesh_simplify_lock_borders(
+    const u32 *indices,
+    u32        index_count,
+    const u32 *ids,
+    const u32 *offsets,
+    const u32 *adjacency,
+    u8        *flags) {
+    for(u32 i= 0; i < index_count; ++i) {
+        u32 a= ids[indices[i]];
+        u32 b= ids[indices[i % 3 == 2 ? i - 2 : i + 1]];
+        if(a == b) continue;
+        u32 shared= 0;
+        for(u32 k= offsets[a]; k < offsets[a + 1]; ++k) {
+            const u32 *corners= indices + 3 * adjacency[k];
+            shared+= ids[corners[0]] == b || ids[corners[1]] == b ||
+                     ids[corners[2]] == b;
+        }
+        if(shared != 2) {
+            flags[a]|= MESH_VERTEX_LOCKED;
+            flags[b]|= MESH_VERTEX_LOCKED;
+        }
+    }
+}
+
+/* True if moving `from` onto `to` turns one of the remaining triangles
+ * around `from` over, with the collapses of this pass applied. */
+static bool
+mesh_simplify_flips(
+    const u32  *indices,
+    const u32  *ids,
+    const u32  *remap,
+    const vec3 *points,
+    const u32  *offsets,
+    const u32  *adjacency,
+    u32         from,
+    u32         to) {
+    vec3 source= points[from];
+    vec3 target= points[to];
+    for(u32 k= offsets[from]; k < offsets[from + 1]; ++k) {
+        const u32 *corners= indices + 3 * adjacency[k];
+        u32        c      = ids[corners[0]] == from ? 0 :
+                            ids[corners[1]] == from ? 1 :
+                                                      2;
+        u32 b= remap[ids[corners[c == 2 ? 0 : c + 1]]];
+        u32 d= remap[ids[corners[c == 0 ? 2 : c - 1]]];
+        if(b == to || d == to || b == d || b == from || d == from) continue;
+        vec3 before= vec3_cross(
+            vec3_sub(points[b], source),
+            vec3_sub(points[d], source));
+        vec3 after= vec3_cross(
+            vec3_sub(points[b], target),
+            vec3_sub(points[d], target));
+        if(vec3_dot(before, after) <= 0.F && vec3_dot(before, before) > 0.F)
+            return true;
+    }
+    return false;
+}
+
+/*============================================================================*/
+/* Edge Collapse                                                              */
+/*============================================================================*/
+/* Counting sort on the leading bits of the errors, which are non-negative
+ * floats and order like their bit patterns. Collapses within a bucket stay
+ * in the order they were found. */
+static void
+mesh_simplify_sort(
+    const mesh_collapse *collapses,
+    u32                  count,
+    u32                 *histogram,
+    u32                 *order) {
+    u32 shift= 31 - MESH_SIMPLIFY_SORT_BITS;
+    __stosb((u8 *)histogram, 0, sizeof(u32) << MESH_SIMPLIFY_SORT_BITS);
+    for(u32 i= 0; i < count; ++i)
+        ++histogram[*(const u32 *)&collapses[i].error >> shift];
+    u32 sum= 0;
+    for(u32 k= 0; k < (1u << MESH_SIMPLIFY_SORT_BITS); ++k) {
+        u32 bucket  = histogram[k];
+        histogram[k]= sum;
+        sum+= bucket;
+    }
+    for(u32 i= 0; i < count; ++i)
+        order[histogram[*(const u32 *)&collapses[i].error >> shift]++]= i;
+}
+
+/* Every pass collapses the cheapest edges whose vertices no other collapse
+ * of the pass touched, up to the error of the edge half again past the
+ * number of collapses still needed, which leaves the rest for later passes
+ * where their neighbours have settled. */
+u32
+mesh_simplify(
+    u32        *indices,
+    u32         index_count,
+    const vec3 *positions,
+    u32         vertex_count,
+    u32         target_index_count,
+    void       *scratch,
+    f32        *out_error) {
+    u64            table_size= hash_table_size(vertex_count);
+    vec3          *points    = scratch;
+    mesh_quadric  *quadrics  = (mesh_quadric *)(points + vertex_count);
+    u32           *ids       = (u32 *)(quadrics + vertex_count);
+    u32           *table     = ids + vertex_count;
+    u32           *remap     = table + table_size;
+    u32           *offsets   = remap + vertex_count;
+    u32           *adjacency = offsets + vertex_count + 1;
+    u32           *order     = adjacency + index_count;
+    u32           *histogram = order + index_count;
+    mesh_collapse *collapses =
+        (mesh_collapse *)(histogram + (1u << MESH_SIMPLIFY_SORT_BITS));
+    u8 *flags = (u8 *)(collapses + index_count);
+    *out_error= 0.F;
+    if(index_count <= target_index_count || !vertex_count) return index_count;
+    /*------------------------------------------------------------------------*/
+    /* Positions Scaled to the Unit Cube                                      */
+    /*------------------------------------------------------------------------*/
+    vec3 aabb_min= positions[0];
+    f32  extent  = 0.F;
+    for(u32 v= 1; v < vertex_count; ++v) {
+        for(u32 c= 0; c < 3; ++c) {
+            if(positions[v].data[c] < aabb_min.data[c])
+                aabb_min.data[c]= positions[v].data[c];
+        }
+    }
+    for(u32 v= 0; v < vertex_count; ++v) {
+        for(u32 c= 0; c < 3; ++c) {
+            f32 offset= positions[v].data[c] - aabb_min.data[c];
+            if(offset > extent) extent= offset;
+        }
+    }
+    f32 scale= extent > 0.F ? 1.F / extent : 1.F;
+    for(u32 v= 0; v < vertex_count; ++v) {
+        for(u32 c= 0; c < 3; ++c) {
+            points[v].data[c]=
+                (positions[v].data[c] - aabb_min.data[c]) * scale;
+        }
+    }
+    /*------------------------------------------------------------------------*/
+    /* Quadrics and Borders                                                   */
+    /*------------------------------------------------------------------------*/
+    mesh_simplify_position_ids(positions, vertex_count, table, ids);
+    __stosb((u8 *)quadrics, 0, sizeof(mesh_quadric) * (u64)vertex_count);
+    for(u32 i= 0; i < index_count; i+= 3) {
+        u32          a= ids[indices[i]];
+        u32          b= ids[indices[i + 1]];
+        u32          c= ids[indices[i + 2]];
+        mesh_quadric quadric;
+        if(!mesh_quadric_from_triangle(
+               points[a],
+               points[b],
+               points[c],
+               &quadric))
+            continue;
+        mesh_quadric_add(&quadrics[a], &quadric);
+        mesh_quadric_add(&quadrics[b], &quadric);
+        mesh_quadric_add(&quadrics[c], &quadric);
+    }
+    mesh_simplify_adjacency(
+        indices,
+        index_count,
+        ids,
+        vertex_count,
+        offsets,
+        adjacency,
+        remap);
+    __stosb(flags, 0, vertex_count);
+    mesh_simplify_lock_borders(
+        indices,
+        index_count,
+        ids,
+        offsets,
+        adjacency,
+        flags);
+    /*------------------------------------------------------------------------*/
+    /* Passes                                                                 */
+    /*------------------------------------------------------------------------*/
+    f32 max_error= 0.F;
+    for(u32 pass= 0; index_count > target_index_count; ++pass) {
+        if(pass) {
+            mesh_simplify_adjacency(
+                indices,
+                index_count,
+                ids,
+                vertex_count,
+                offsets,
+                adjacency,
+                remap);
+        }
+        // Interior edges show up once in each direction, the ascending one
+        // stands for both
+        u32 collapse_count= 0;
+        for(u32 i= 0; i < index_count; ++i) {
+            u32 a= ids[indices[i]];
+            u32 b= ids[indices[i % 3 == 2 ? i - 2 : i + 1]];
+            if(a >= b) continue;
+            bool a_moves= !(flags[a] & MESH_VERTEX_LOCKED);
+            bool b_moves= !(flags[b] & MESH_VERTEX_LOCKED);
+            if(!a_moves && !b_moves) continue;
+            mesh_collapse *collapse= &collapses[collapse_count++];
+            f32 a_error= a_moves ? mesh_quadric_error(&quadrics[a], points[b]) :
+                                   0.F;
+            f32 b_error= b_moves ? mesh_quadric_error(&quadrics[b], points[a]) :
+                                   0.F;
+            if(a_moves && (!b_moves || a_error <= b_error))
+                *collapse= (mesh_collapse){a, b, a_error};
+            else *collapse= (mesh_collapse){b, a, b_error};
+        }
+        if(!collapse_count) break;
+        mesh_simplify_sort(collapses, collapse_count, histogram, order);
+        // Interior collapses take two triangles along
+        u32 triangle_goal= (index_count - target_index_count + 2) / 3;
+        u32 limit_rank   = triangle_goal / 2 + triangle_goal / 4;
+        if(limit_rank >= collapse_count) limit_rank= collapse_count - 1;
+        f32 error_limit= collapses[order[limit_rank]].error;
+        // Close to the target the few collapses left take the cheapest
+        // edges there are instead of one more pass each
+        bool limited= triangle_goal > index_count / 48;
+        for(u32 v= 0; v < vertex_count; ++v) {
+            remap[v]= v;
+            flags[v]&= ~MESH_VERTEX_TOUCHED;
+        }
+        u32 removed= 0;
+        for(u32 i= 0; i < collapse_count && removed < triangle_goal; ++i) {
+            const mesh_collapse *collapse= &collapses[order[i]];
+            // Cheap edges that can't collapse don't stall the pass, it
+            // goes past the limit until it reached a quarter of its goal
+            if(limited && collapse->error > error_limit &&
+               removed >= (triangle_goal + 3) / 4)
+                break;
+            if((flags[collapse->from] | flags[collapse->to]) &
+               MESH_VERTEX_TOUCHED)
+                continue;
+            if(mesh_simplify_flips(
+                   indices,
+                   ids,
+                   remap,
+                   points,
+                   offsets,
+                   adjacency,
+                   collapse->from,
+                   collapse->to))
+                continue;
+            remap[collapse->from]= collapse->to;
+            mesh_quadric_add(
+                &quadrics[collapse->to],
+                &quadrics[collapse->from]);
+            flags[collapse->from]|= MESH_VERTEX_TOUCHED;
+            flags[collapse->to]|= MESH_VERTEX_TOUCHED;
+            if(collapse->error > max_error) max_error= collapse->error;
+            removed+= 2;
+        }
+        if(!removed) break;
+        // Moved corners take the vertex their position id names, triangles
+        // that lost a corner go
+        u32 kept_count= 0;
+        for(u32 i= 0; i < index_count; i+= 3) {
+            u32 corners[3];
+            for(u32 c= 0; c < 3; ++c) {
+                u32 vertex= indices[i + c];
+                u32 id    = remap[ids[vertex]];
+                corners[c]= id == ids[vertex] ? vertex : id;
+            }
+            u32 a= ids[corners[0]], b= ids[corners[1]], c= ids[corners[2]];
+            if(a == b || b == c || a == c) continue;
+            indices[kept_count++]= corners[0];
+            indices[kept_count++]= corners[1];
+            indices[kept_count++]= corners[2];
+        }
+        index_count= kept_count;
+    }
+    *out_error= sqrt_f32(max_error) * extent;
+    return index_count;
+}
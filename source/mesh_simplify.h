@@ -0,0 +1,30 @@
+#pragma once
+
+#include "types.h"
+
+/* Load-time simplification of indexed triangle lists with the quadric error
+ * metric of Garland and Heckbert (1997). Edges collapse onto one of their
+ * own vertices, so a simplified list still indexes the vertex buffer of its
+ * source and a level of detail only adds an index range. Vertices at the
+ * same position move together, which keeps normal and UV seams closed, and
+ * vertices on open or non-manifold edges never move, which keeps borders
+ * and holes where they are. */
+
+u64
+mesh_simplify_scratch_size(u32 index_count, u32 vertex_count);
+/* Collapses edges of the list in place, cheapest first, until at most
+ * `target_index_count` indices are left or no edge can collapse without
+ * flipping a triangle, and returns the new index count. `out_error`
+ * receives the error of the worst collapse as a distance in the units of
+ * `positions`, the root of the area-weighted mean squared distance of the
+ * moved vertex to the planes of its original triangles. The list has to
+ * pass mesh_triangles_valid(). */
+u32
+mesh_simplify(
+    u32        *indices,
+    u32         index_count,
+    const vec3 *positions,
+    u32         vertex_count,
+    u32         target_index_count,
+    void       *scratch,
+    f32        *out_error);
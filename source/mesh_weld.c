@@ -0,0 +1,60 @@
+#include <intrin.h>
+
+#include "mesh_weld.h"
+#include "utils.h"
+
+u64
+mesh_weld_scratch_size(u32 vertex_count) {
+    // The remap list and the table
+    return sizeof(u32) * (vertex_count + hash_table_size(vertex_count));
+}
+
+static bool
+mesh_weld_equal(const u32 *a, const u32 *b, u32 word_count) {
+    for(u32 i= 0; i < word_count; ++i)
+        if(a[i] != b[i]) return false;
+    return true;
+}
+
+u32
+mesh_weld_vertices(
+    u8   *vertices,
+    u32   vertex_size,
+    u32   vertex_count,
+    u32  *indices,
+    u32   index_count,
+    void *scratch) {
+    for(u32 i= 0; i < index_count; ++i)
+        if(indices[i] >= vertex_count) return vertex_count;
+    u64  table_size= hash_table_size(vertex_count);
+    u64  slot_mask = table_size - 1;
+    u32 *remap     = scratch;
+    u32 *table     = remap + vertex_count;
+    u32  word_count= vertex_size / sizeof(u32);
+    __stosb((u8 *)table, 0xFF, sizeof(u32) * table_size);
+    // Distinct vertices move down to weld_count, which never passes the
+    // vertex being looked up, so the table only points at moved vertices
+    u32 weld_count= 0;
+    for(u32 v= 0; v < vertex_count; ++v) {
+        const u32 *vertex= (const u32 *)(vertices + (u64)vertex_size * v);
+        u64        slot  = hash_words(vertex, word_count) & slot_mask;
+        while(table[slot] != ~(0u)) {
+            const u32 *other=
+                (const u32 *)(vertices + (u64)vertex_size * table[slot]);
+            if(mesh_weld_equal(vertex, other, word_count)) break;
+            slot= (slot + 1) & slot_mask;
+        }
+        if(table[slot] == ~(0u)) {
+            if(weld_count != v) {
+                __movsb(
+                    vertices + (u64)vertex_size * weld_count,
+                    (const u8 *)vertex,
+                    vertex_size);
+            }
+            table[slot]= weld_count++;
+        }
+        remap[v]= table[slot];
+    }
+    for(u32 i= 0; i < index_count; ++i) indices[i]= remap[indices[i]];
+    return weld_count;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "types.h"
+
+/* Load-time merging of vertices that are bit-for-bit identical in the
+ * loader's vertex format. Vertices are hashed into an open-addressing table
+ * with linear probing, so quantized formats also merge vertices that only
+ * differed below their precision. */
+
+u64
+mesh_weld_scratch_size(u32 vertex_count);
+/* Moves the first occurrence of every distinct vertex to the front in
+ * source order, rewrites the indices and returns the new vertex count.
+ * `vertex_size` must be a multiple of 4. Lists with an index past
+ * `vertex_count` are left as they are and keep their count. */
+u32
+mesh_weld_vertices(
+    u8   *vertices,
+    u32   vertex_size,
+    u32   vertex_count,
+    u32  *indices,
+    u32   index_count,
+    void *scratch);
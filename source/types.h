@@ -57,3 +57,15 @@ typedef struct vertex {
     vec4 pos;
     vec4 nrm;
 } vertex;
+
+/* Quantized layouts, positions are 16-bit snorm inside the bounds of their
+ * primitive and normals are octahedral snorm pairs. */
+typedef struct vertex_oct16 {
+    s16 pos[4];
+    s16 nrm[2];
+} vertex_oct16;
+
+typedef struct vertex_oct8 {
+    s16 pos[3];
+    u8  nrm[2]; // snorm8 bit patterns
+} vertex_oct8;
@@ -1,3 +1,5 @@
+#include <intrin.h>
+
 #include "utils.h"
 
 bool
@@ -16,4 +18,107 @@ convert_string_to_u32(const char *str, u64 length) {
         out+= str[i] - 0x30;
     }
     return out;
+}
+
+u64
+convert_string_to_u64(const char *str, u64 length) {
+    u64 out= 0;
+    for(u64 i= 0; i < length; ++i) {
+        out*= 10;
+        out+= str[i] - 0x30;
+    }
+    return out;
+}
+#define HASH_PRIME_1 0x9E3779B185EBCA87ull
+#define HASH_PRIME_2 0xC2B2AE3D27D4EB4Full
+#define HASH_PRIME_3 0x165667B19E3779F9ull
+#define HASH_PRIME_4 0x85EBCA77C2B2AE63ull
+#define HASH_PRIME_5 0x27D4EB2F165667C5ull
+
+static u64
+hash_rotate(u64 value, u32 bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static u64
+hash_round(u64 acc, u64 input) {
+    acc+= input * HASH_PRIME_2;
+    return hash_rotate(acc, 31) * HASH_PRIME_1;
+}
+
+static u64
+hash_merge(u64 acc, u64 value) {
+    acc^= hash_round(0, value);
+    return acc * HASH_PRIME_1 + HASH_PRIME_4;
+}
+
+u64
+hash_bytes(const void *data, u64 size, u64 seed) {
+    const u8 *bytes= data;
+    const u8 *end  = bytes + size;
+    u64       hash;
+    if(size >= 32) {
+        u64 lanes[4]= {
+            seed + HASH_PRIME_1 + HASH_PRIME_2,
+            seed + HASH_PRIME_2,
+            seed,
+            seed - HASH_PRIME_1};
+        for(; end - bytes >= 32; bytes+= 32) {
+            for(u32 i= 0; i < 4; ++i)
+                lanes[i]= hash_round(lanes[i], ((const u64 *)bytes)[i]);
+        }
+        hash= hash_rotate(lanes[0], 1) + hash_rotate(lanes[1], 7) +
+              hash_rotate(lanes[2], 12) + hash_rotate(lanes[3], 18);
+        for(u32 i= 0; i < 4; ++i) hash= hash_merge(hash, lanes[i]);
+    } else {
+        hash= seed + HASH_PRIME_5;
+    }
+    hash+= size;
+    for(; end - bytes >= 8; bytes+= 8) {
+        hash^= hash_round(0, *(const u64 *)bytes);
+        hash = hash_rotate(hash, 27) * HASH_PRIME_1 + HASH_PRIME_4;
+    }
+    if(end - bytes >= 4) {
+        hash^= (u64)*(const u32 *)bytes * HASH_PRIME_1;
+        hash = hash_rotate(hash, 23) * HASH_PRIME_2 + HASH_PRIME_3;
+        bytes+= 4;
+    }
+    for(; bytes < end; ++bytes) {
+        hash^= *bytes * HASH_PRIME_5;
+        hash = hash_rotate(hash, 11) * HASH_PRIME_1;
+    }
+    hash^= hash >> 33;
+    hash*= HASH_PRIME_2;
+    hash^= hash >> 29;
+    hash*= HASH_PRIME_3;
+    return hash ^ (hash >> 32);
+}
+
+u64
+hash_table_size(u32 count) {
+    u64 table_size= 1;
+    while(table_size < 2ull * count) table_size<<= 1;
+    return table_size;
+}
+
+u64
+hash_words(const u32 *words, u32 word_count) {
+    u64 hash= 0xCBF29CE484222325ull;
+    for(u32 i= 0; i < word_count; ++i)
+        hash= (hash ^ words[i]) * 0x9E3779B97F4A7C15ull;
+    return hash ^ (hash >> 29);
+}
+
+bool
+cpu_has_avx2(void) {
+    int info[4];
+    __cpuid(info, 0);
+    if(info[0] < 7) return false;
+    __cpuid(info, 1);
+    // AVX needs both the instructions and the OS saving the ymm state
+    const int osxsave_avx= (1 << 27) | (1 << 28);
+    if((info[2] & osxsave_avx) != osxsave_avx || (_xgetbv(0) & 6) != 6)
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
 }
\ No newline at end of file
@@ -5,4 +5,20 @@
 bool
 compare_string_utf8(const char *val, u64 length, const char *cmp);
 u32
-convert_string_to_u32(const char *str, u64 length);
\ No newline at end of file
+convert_string_to_u32(const char *str, u64 length);
+u64
+convert_string_to_u64(const char *str, u64 length);
+/* 64-bit XXH64 of `size` bytes, for content keys rather than hash tables. */
+u64
+hash_bytes(const void *data, u64 size, u64 seed);
+/* Power of two at least twice `count`, which keeps the linear probe
+ * sequences of an open-addressing table short even when every key is
+ * distinct. */
+u64
+hash_table_size(u32 count);
+/* Hash of `word_count` 32-bit words for open-addressing tables. */
+u64
+hash_words(const u32 *words, u32 word_count);
+/* True when the CPU has AVX2 and the OS saves the ymm state. */
+bool
+cpu_has_avx2(void);
\ No newline at end of file
@@ -0,0 +1,225 @@
+#include <intrin.h>
+
+#include "vertex_convert.h"
+#include "utils.h"
+
+static void
+vertex_convert_scalar(
+    const vec3 *pos_data,
+    const vec3 *nrm_data,
+    u32         count,
+    vertex     *vertices) {
+    for(u32 i= 0; i < count; ++i) {
+        // Both sources are loaded before the store, which may cover them
+        vec3 pos= pos_data[i];
+        vec3 nrm= nrm_data[i];
+        vec4_set(vertices[i].pos, pos.x, pos.y, pos.z, 1.F);
+        vec4_set(vertices[i].nrm, nrm.x, nrm.y, nrm.z, 0.F);
+    }
+}
+
+/* Four packed vec3 are three registers, x0 y0 z0 x1 | y1 z1 x2 y2 |
+ * z2 x3 y3 z3, and are spread over four registers with w left undefined. */
+static u32
+vertex_convert_sse2(
+    const vec3 *pos_data,
+    const vec3 *nrm_data,
+    u32         count,
+    vertex     *vertices) {
+    const __m128 xyz_mask= _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+    const __m128 w_one   = _mm_set_ps(1.F, 0.F, 0.F, 0.F);
+    const f32   *pos     = (const f32 *)pos_data;
+    const f32   *nrm     = (const f32 *)nrm_data;
+    f32         *out     = (f32 *)vertices;
+    u32          i       = 0;
+    for(; i + 4 <= count; i+= 4, pos+= 12, nrm+= 12, out+= 32) {
+        __m128 a = _mm_loadu_ps(pos);
+        __m128 b = _mm_loadu_ps(pos + 4);
+        __m128 c = _mm_loadu_ps(pos + 8);
+        __m128 t = _mm_shuffle_ps(b, a, _MM_SHUFFLE(3, 3, 1, 0));
+        __m128 p1= _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 1, 0, 2));
+        __m128 p2= _mm_shuffle_ps(b, c, _MM_SHUFFLE(0, 0, 3, 2));
+        __m128 p3= _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 2, 1));
+        _mm_storeu_ps(out, _mm_or_ps(_mm_and_ps(a, xyz_mask), w_one));
+        _mm_storeu_ps(out + 8, _mm_or_ps(_mm_and_ps(p1, xyz_mask), w_one));
+        _mm_storeu_ps(out + 16, _mm_or_ps(_mm_and_ps(p2, xyz_mask), w_one));
+        _mm_storeu_ps(out + 24, _mm_or_ps(_mm_and_ps(p3, xyz_mask), w_one));
+        a = _mm_loadu_ps(nrm);
+        b = _mm_loadu_ps(nrm + 4);
+        c = _mm_loadu_ps(nrm + 8);
+        t = _mm_shuffle_ps(b, a, _MM_SHUFFLE(3, 3, 1, 0));
+        p1= _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 1, 0, 2));
+        p2= _mm_shuffle_ps(b, c, _MM_SHUFFLE(0, 0, 3, 2));
+        p3= _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 2, 1));
+        _mm_storeu_ps(out + 4, _mm_and_ps(a, xyz_mask));
+        _mm_storeu_ps(out + 12, _mm_and_ps(p1, xyz_mask));
+        _mm_storeu_ps(out + 20, _mm_and_ps(p2, xyz_mask));
+        _mm_storeu_ps(out + 28, _mm_and_ps(p3, xyz_mask));
+    }
+    return i;
+}
+
+/* A vertex is exactly one ymm register, position in the low and normal in
+ * the high lane. Each lane is filled by a 16 byte load starting at its vec3,
+ * which picks up the next x as w, so the last vertex is left to the scalar
+ * loop to stay inside the sources. */
+static u32
+vertex_convert_avx2(
+    const vec3 *pos_data,
+    const vec3 *nrm_data,
+    u32         count,
+    vertex     *vertices) {
+    const __m256 w_consts=
+        _mm256_set_ps(0.F, 0.F, 0.F, 0.F, 1.F, 0.F, 0.F, 0.F);
+    const f32 *pos= (const f32 *)pos_data;
+    const f32 *nrm= (const f32 *)nrm_data;
+    f32       *out= (f32 *)vertices;
+    u32        i  = 0;
+    for(; i + 5 <= count; i+= 4, pos+= 12, nrm+= 12, out+= 32) {
+        __m256 v0= _mm256_insertf128_ps(
+            _mm256_castps128_ps256(_mm_loadu_ps(pos)),
+            _mm_loadu_ps(nrm),
+            1);
+        __m256 v1= _mm256_insertf128_ps(
+            _mm256_castps128_ps256(_mm_loadu_ps(pos + 3)),
+            _mm_loadu_ps(nrm + 3),
+            1);
+        __m256 v2= _mm256_insertf128_ps(
+            _mm256_castps128_ps256(_mm_loadu_ps(pos + 6)),
+            _mm_loadu_ps(nrm + 6),
+            1);
+        __m256 v3= _mm256_insertf128_ps(
+            _mm256_castps128_ps256(_mm_loadu_ps(pos + 9)),
+            _mm_loadu_ps(nrm + 9),
+            1);
+        _mm256_storeu_ps(out, _mm256_blend_ps(v0, w_consts, 0x88));
+        _mm256_storeu_ps(out + 8, _mm256_blend_ps(v1, w_consts, 0x88));
+        _mm256_storeu_ps(out + 16, _mm256_blend_ps(v2, w_consts, 0x88));
+        _mm256_storeu_ps(out + 24, _mm256_blend_ps(v3, w_consts, 0x88));
+    }
+    return i;
+}
+
+vertex_convert_isa
+vertex_convert_best_isa(void) {
+    return cpu_has_avx2() ? vertex_convert_isa_avx2 : vertex_convert_isa_sse2;
+}
+
+void
+vertex_convert(
+    vertex_convert_isa isa,
+    const vec3        *pos_data,
+    const vec3        *nrm_data,
+    u32                count,
+    vertex            *vertices) {
+    u32 done= 0;
+    if(isa == vertex_convert_isa_avx2)
+        done= vertex_convert_avx2(pos_data, nrm_data, count, vertices);
+    else if(isa == vertex_convert_isa_sse2)
+        done= vertex_convert_sse2(pos_data, nrm_data, count, vertices);
+    vertex_convert_scalar(
+        pos_data + done,
+        nrm_data + done,
+        count - done,
+        vertices + done);
+}
+
+u32
+vertex_format_size(vertex_format format) {
+    switch(format) {
+    case vertex_format_oct16: return sizeof(vertex_oct16);
+    case vertex_format_oct8: return sizeof(vertex_oct8);
+    default: return sizeof(vertex);
+    }
+}
+
+/* Rounds to nearest after clamping to [-1, 1]. */
+static s32
+vertex_snorm(f32 value, f32 max) {
+    if(!(value > -1.F)) value= -1.F;
+    if(value > 1.F) value= 1.F;
+    value*= max;
+    return (s32)(value + (value < 0.F ? -.5F : .5F));
+}
+
+/* Projects the normal onto the octahedron |x| + |y| + |z| = 1 and unfolds
+ * the lower half over the corners, a zero normal maps to +z. */
+static void
+vertex_octahedral(vec3 nrm, f32 *out_x, f32 *out_y) {
+    f32 abs_x= nrm.x < 0.F ? -nrm.x : nrm.x;
+    f32 abs_y= nrm.y < 0.F ? -nrm.y : nrm.y;
+    f32 abs_z= nrm.z < 0.F ? -nrm.z : nrm.z;
+    f32 sum  = abs_x + abs_y + abs_z;
+    f32 x    = sum > 0.F ? nrm.x / sum : 0.F;
+    f32 y    = sum > 0.F ? nrm.y / sum : 0.F;
+    if(nrm.z < 0.F) {
+        f32 folded_x= (1.F - (y < 0.F ? -y : y)) * (x < 0.F ? -1.F : 1.F);
+        f32 folded_y= (1.F - (x < 0.F ? -x : x)) * (y < 0.F ? -1.F : 1.F);
+        x           = folded_x;
+        y           = folded_y;
+    }
+    *out_x= x;
+    *out_y= y;
+}
+
+void
+vertex_quantize(
+    vertex_format format,
+    const vec3   *pos_data,
+    const vec3   *nrm_data,
+    u32           count,
+    const vec3   *offset,
+    const vec3   *scale,
+    void         *vertices) {
+    vec3 inv_scale= {1.F / scale->x, 1.F / scale->y, 1.F / scale->z};
+    for(u32 i= 0; i < count; ++i) {
+        vec3 pos= pos_data[i];
+        s16  x  = (s16)vertex_snorm((pos.x - offset->x) * inv_scale.x, 32767.F);
+        s16  y  = (s16)vertex_snorm((pos.y - offset->y) * inv_scale.y, 32767.F);
+        s16  z  = (s16)vertex_snorm((pos.z - offset->z) * inv_scale.z, 32767.F);
+        f32  oct_x, oct_y;
+        vertex_octahedral(nrm_data[i], &oct_x, &oct_y);
+        if(format == vertex_format_oct16) {
+            vertex_oct16 *out= &((vertex_oct16 *)vertices)[i];
+            out->pos[0]      = x;
+            out->pos[1]      = y;
+            out->pos[2]      = z;
+            out->pos[3]      = 0;
+            out->nrm[0]      = (s16)vertex_snorm(oct_x, 32767.F);
+            out->nrm[1]      = (s16)vertex_snorm(oct_y, 32767.F);
+        } else {
+            vertex_oct8 *out= &((vertex_oct8 *)vertices)[i];
+            out->pos[0]     = x;
+            out->pos[1]     = y;
+            out->pos[2]     = z;
+            out->nrm[0]     = (u8)vertex_snorm(oct_x, 127.F);
+            out->nrm[1]     = (u8)vertex_snorm(oct_y, 127.F);
+        }
+    }
+}
+
+void
+vertex_write_normals(
+    vertex_format format,
+    const vec3   *nrm_data,
+    u32           count,
+    void         *vertices) {
+    for(u32 i= 0; i < count; ++i) {
+        vec3 nrm= nrm_data[i];
+        if(format == vertex_format_float) {
+            vec4_set(((vertex *)vertices)[i].nrm, nrm.x, nrm.y, nrm.z, 0.F);
+            continue;
+        }
+        f32 oct_x, oct_y;
+        vertex_octahedral(nrm, &oct_x, &oct_y);
+        if(format == vertex_format_oct16) {
+            vertex_oct16 *out= &((vertex_oct16 *)vertices)[i];
+            out->nrm[0]      = (s16)vertex_snorm(oct_x, 32767.F);
+            out->nrm[1]      = (s16)vertex_snorm(oct_y, 32767.F);
+        } else {
+            vertex_oct8 *out= &((vertex_oct8 *)vertices)[i];
+            out->nrm[0]     = (u8)vertex_snorm(oct_x, 127.F);
+            out->nrm[1]     = (u8)vertex_snorm(oct_y, 127.F);
+        }
+    }
+}
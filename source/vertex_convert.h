@@ -0,0 +1,55 @@
+#pragma once
+
+#include "types.h"
+
+/* Widens tightly packed float3 POSITION and NORMAL data into `vertex`, with
+ * w set to 1 for positions and 0 for normals. The SIMD kernels convert four
+ * vertices per iteration and finish the tail with the scalar loop. */
+typedef enum vertex_convert_isa {
+    vertex_convert_isa_scalar,
+    vertex_convert_isa_sse2,
+    vertex_convert_isa_avx2,
+    vertex_convert_isa_max_enum= ~(0u)
+} vertex_convert_isa;
+
+vertex_convert_isa
+vertex_convert_best_isa(void);
+/* `vertices` must not overlap the sources, except for a single vertex
+ * written over its own raw data. */
+void
+vertex_convert(
+    vertex_convert_isa isa,
+    const vec3        *pos_data,
+    const vec3        *nrm_data,
+    u32                count,
+    vertex            *vertices);
+
+/* Layout of the shared vertex buffer. */
+typedef enum vertex_format {
+    vertex_format_float, // vertex, 32 bytes
+    vertex_format_oct16, // vertex_oct16, 12 bytes
+    vertex_format_oct8,  // vertex_oct8, 8 bytes
+    vertex_format_max_enum= ~(0u)
+} vertex_format;
+
+u32
+vertex_format_size(vertex_format format);
+/* Writes a quantized layout, positions are stored as (pos - offset) / scale
+ * and have to lie within `scale` of `offset`. */
+void
+vertex_quantize(
+    vertex_format format,
+    const vec3   *pos_data,
+    const vec3   *nrm_data,
+    u32           count,
+    const vec3   *offset,
+    const vec3   *scale,
+    void         *vertices);
+/* Replaces the normals of `count` vertices of any layout and leaves their
+ * positions as they are. */
+void
+vertex_write_normals(
+    vertex_format format,
+    const vec3   *nrm_data,
+    u32           count,
+    void         *vertices);
@@ -0,0 +1,166 @@
+"""Generates the perfect-hash key tables of source/main.c.
+
+Every table lists the property names of one glTF object type with the enum
+value gltf_lookup_key() returns for them. The seed search is deterministic, so
+running this again for an unchanged key list reproduces the same seeds. After
+adding a key here, paste the printed table over the old one in main.c.
+
+    python tools/gen_key_tables.py [table...]   print the tables
+    python tools/gen_key_tables.py --check      compare them with main.c
+"""
+import os
+import random
+import sys
+
+TABLES = [
+    ("gltf_accessor_keys", "gltf_accessor_key_slots", [
+        ("bufferView", "gltf_accessor_key_buffer_view"),
+        ("byteOffset", "gltf_accessor_key_byte_offset"),
+        ("componentType", "gltf_accessor_key_component_type"),
+        ("count", "gltf_accessor_key_count"),
+        ("type", "gltf_accessor_key_type"),
+        ("max", "gltf_accessor_key_max"),
+        ("min", "gltf_accessor_key_min"),
+        ("normalized", "gltf_accessor_key_normalized"),
+    ]),
+    ("gltf_accessor_types", "gltf_accessor_type_slots", [
+        ("SCALAR", "gltf_accessor_scalar"),
+        ("VEC2", "gltf_accessor_vec2"),
+        ("VEC3", "gltf_accessor_vec3"),
+        ("VEC4", "gltf_accessor_vec4"),
+        ("MAT2", "gltf_accessor_mat2"),
+        ("MAT3", "gltf_accessor_mat3"),
+        ("MAT4", "gltf_accessor_mat4"),
+    ]),
+    ("gltf_buffer_keys", "gltf_buffer_key_slots", [
+        ("byteLength", "gltf_buffer_key_byte_length"),
+    ]),
+    ("gltf_buffer_view_keys", "gltf_buffer_view_key_slots", [
+        ("buffer", "gltf_buffer_view_key_buffer"),
+        ("byteLength", "gltf_buffer_view_key_byte_length"),
+        ("byteOffset", "gltf_buffer_view_key_byte_offset"),
+        ("byteStride", "gltf_buffer_view_key_byte_stride"),
+        ("target", "gltf_buffer_view_key_target"),
+    ]),
+    ("gltf_pbr_keys", "gltf_pbr_key_slots", [
+        ("baseColorFactor", "gltf_pbr_key_base_color_factor"),
+        ("baseColorTexture", "gltf_pbr_key_base_color_texture"),
+        ("metallicFactor", "gltf_pbr_key_metallic_factor"),
+        ("metallicTexture", "gltf_pbr_key_metallic_texture"),
+    ]),
+    ("gltf_material_keys", "gltf_material_key_slots", [
+        ("emissiveFactor", "gltf_material_key_emissive_factor"),
+        ("emissiveTexture", "gltf_material_key_emissive_texture"),
+        ("normalTexture", "gltf_material_key_normal_texture"),
+        ("occlusionTexture", "gltf_material_key_occlusion_texture"),
+        ("name", "gltf_material_key_name"),
+        ("pbrMetallicRoughness", "gltf_material_key_pbr_metallic_roughness"),
+    ]),
+    ("gltf_primitive_keys", "gltf_primitive_key_slots", [
+        ("attributes", "gltf_primitive_key_attributes"),
+        ("indices", "gltf_primitive_key_indices"),
+        ("material", "gltf_primitive_key_material"),
+        ("mode", "gltf_primitive_key_mode"),
+    ]),
+    ("gltf_attribute_keys", "gltf_attribute_key_slots", [
+        ("POSITION", "gltf_attribute_key_position"),
+        ("NORMAL", "gltf_attribute_key_normal"),
+    ]),
+    ("gltf_mesh_keys", "gltf_mesh_key_slots", [
+        ("name", "gltf_mesh_key_name"),
+        ("primitives", "gltf_mesh_key_primitives"),
+    ]),
+    ("gltf_scene_keys", "gltf_scene_key_slots", [
+        ("name", "gltf_scene_key_name"),
+        ("nodes", "gltf_scene_key_nodes"),
+    ]),
+    ("gltf_node_keys", "gltf_node_key_slots", [
+        ("name", "gltf_node_key_name"),
+        ("mesh", "gltf_node_key_mesh"),
+        ("children", "gltf_node_key_children"),
+        ("matrix", "gltf_node_key_matrix"),
+        ("rotation", "gltf_node_key_rotation"),
+        ("scale", "gltf_node_key_scale"),
+        ("translation", "gltf_node_key_translation"),
+    ]),
+    ("gltf_json_keys", "gltf_json_key_slots", [
+        ("accessors", "gltf_json_key_accessors"),
+        ("asset", "gltf_json_key_asset"),
+        ("bufferViews", "gltf_json_key_buffer_views"),
+        ("buffers", "gltf_json_key_buffers"),
+        ("images", "gltf_json_key_images"),
+        ("materials", "gltf_json_key_materials"),
+        ("meshes", "gltf_json_key_meshes"),
+        ("scenes", "gltf_json_key_scenes"),
+        ("scene", "gltf_json_key_scene"),
+        ("nodes", "gltf_json_key_nodes"),
+    ]),
+]
+
+
+def key_hash(key):
+    """The hash of gltf_lookup_key(), before the multiply."""
+    b = key.encode()
+    n = len(b)
+    return ((b[0] << 24) | (b[n // 2] << 16) | (b[n - 1] << 8) | n) & 0xFFFFFFFF
+
+
+def find_seed(keys):
+    """Returns the first odd multiplier sending every key to its own slot,
+    using the smallest power of two table that holds all keys."""
+    hashes = [key_hash(k) for k, _ in keys]
+    bits = max(1, (len(keys) - 1).bit_length())
+    while bits < 32:
+        rng = random.Random(1)
+        for _ in range(1 << 20):
+            seed = rng.getrandbits(32) | 1
+            slots = [((h * seed) & 0xFFFFFFFF) >> (32 - bits) for h in hashes]
+            if len(set(slots)) == len(keys):
+                return seed, 32 - bits
+        bits += 1
+    raise RuntimeError("no seed found")
+
+
+def emit_table(name, slots_name, keys):
+    seed, shift = find_seed(keys)
+    slot_count = 1 << (32 - shift)
+    entries = {}
+    for key, id in keys:
+        entries[((key_hash(key) * seed) & 0xFFFFFFFF) >> shift] = (key, id)
+    width = len("[%d]" % max(entries))
+    lines = ["static const gltf_key %s[%d]= {" % (slots_name, slot_count)]
+    for slot in sorted(entries):
+        key, id = entries[slot]
+        index = ("[%d]" % slot).ljust(width)
+        value = '{"%s", %d, %s},' % (key, len(key.encode()), id)
+        line = "    %s= %s" % (index, value)
+        if len(line) > 80:
+            lines.append("    %s=" % index)
+            lines.append("        %s" % value)
+        else:
+            lines.append(line)
+    lines.append("};")
+    lines.append("static const gltf_key_table %s= {" % name)
+    lines.append("    %s," % slots_name)
+    lines.append("    0x%08Xu," % seed)
+    lines.append("    %d};" % shift)
+    return "\n".join(lines) + "\n"
+
+
+def main(args):
+    if args[:1] == ["--check"]:
+        path = os.path.join(os.path.dirname(__file__), "..", "source", "main.c")
+        with open(path, newline="") as f:
+            source = f.read()
+        stale = [t[0] for t in TABLES if emit_table(*t) not in source]
+        for name in stale:
+            print("%s differs from main.c" % name)
+        return 1 if stale else 0
+    for table in TABLES:
+        if not args or table[0] in args:
+            sys.stdout.write(emit_table(*table) + "\n")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))